@@ -162,6 +162,7 @@
      (vicare posix daemonisations)
      (vicare posix simple-event-loop)
      (vicare posix tcp-server-sockets)
+     (vicare posix async-io)
      (vicare posix sendmail)
      (vicare posix mailx)
      (vicare posix curl)
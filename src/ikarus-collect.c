@@ -37,6 +37,9 @@
 #include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#if ((defined __AVX2__) || (defined __SSE2__))
+#  include <immintrin.h>
+#endif
 
 
 /** --------------------------------------------------------------------
@@ -102,6 +105,9 @@ typedef struct gc_t {
 
   int		collect_gen;
   uint32_t	collect_gen_tag;
+  /* The generation selected by the schedule, before postponing it; see
+     "postponed_generation()". */
+  int		scheduled_gen;
 
   /* These fields are for the hash tables. */
   ikptr_t		tconc_ap;
@@ -109,6 +115,23 @@ typedef struct gc_t {
   ikptr_t		tconc_base;
   ikmemblock_t *	tconc_queue;
   ik_ptr_page_t *	forward_list;
+
+  /* Statistics: number of bytes of live objects moved in every type of
+     meta page, and number of bytes of large objects kept in place. */
+  ikuword_t	copied_bytes[meta_count];
+  ikuword_t	large_object_bytes;
+  /* Number  of objects, and  bytes of  the page  runs holding  them, in the
+     large object space after this run; only objects of the collected
+     generations are counted. */
+  ikuword_t	large_objects_count;
+  ikuword_t	large_objects_bytes;
+  ikuword_t	dirty_pages;		/* number of dirty pages scanned */
+  ikuword_t	guarded_objects;	/* number of guarded objects inspected */
+  ikuword_t	finalized_objects;	/* number of guarded objects found dead */
+  /* Statistics of  the sweeps  of the segments vector:  microseconds spent
+     in them and number of page slots visited. */
+  ikuword_t	sweep_usecs;
+  ikuword_t	swept_pages;
 } gc_t;
 
 
@@ -130,10 +153,18 @@ static void	relocate_code_object (ikptr_t p_code_object, gc_t* gc);
 
 static void	register_to_collect_count (ikpcb_t* pcb, int bytes);
 
+static void	log_collection (gc_t * gc, ikuword_t real_usecs, ikuword_t user_usecs, ikuword_t sys_usecs);
+
 static ikpcb_t *perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, ikpcb_t* pcb);
 
 /* Prototypes for subroutines of "perform_garbage_collection()". */
 static int		collection_id_to_gen	(int id);
+static int		adaptive_generation	(ikpcb_t * pcb);
+static void		register_survivors	(gc_t * gc, ikuword_t nursery_bytes);
+static ikuword_t	nursery_target_size	(ikpcb_t * pcb);
+static void		register_large_objects	(gc_t * gc);
+static int		postponed_generation	(ikpcb_t * pcb, int scheduled_generation);
+static void		register_pause_time	(ikpcb_t * pcb, int collected_generation, ikuword_t pause_usecs);
 static void		fix_weak_pointers	(gc_t *gc);
 static inline void	collect_locatives	(gc_t*, ik_callback_locative_t*);
 static void		deallocate_unused_pages	(gc_t*);
@@ -160,6 +191,8 @@ static ikptr_t gather_live_object_proc(gc_t* gc, ikptr_t x);
 
 extern int		ik_garbage_collection_is_forbidden;
 extern ikuword_t	ik_customisable_heap_nursery_size;
+extern ikuword_t	ik_gc_postponement_threshold_usecs;
+extern int		ik_gc_adaptive_schedule;
 
 /* When true: internals inspection messages  are enabled.  It is used by
    the preprocessor macro "IK_RUNTIME_MESSAGE()". */
@@ -211,6 +244,17 @@ ikrt_disable_gc_integrity_checks (ikpcb_t * pcb) {
  ** Helpers.
  ** ----------------------------------------------------------------- */
 
+/* Number of collections  between two runs of  "ik_decay_page_cache()": a
+   cached page must stay unused this long before its memory is returned
+   to the OS. */
+#define GC_PAGE_CACHE_DECAY_INTERVAL	8
+
+/* Minimum size in bytes of the data area of strings and bytevectors that
+   are stored in the large object space; see "register_large_objects()".
+   Smaller objects are copied into the meta pages for data, where up to a
+   page would be wasted for them. */
+#define GC_LARGE_DATA_MIN_SIZE		(4 * IK_PAGESIZE)
+
 static void
 ik_munmap_from_segment (ikptr_t base, ikuword_t size, ikpcb_t* pcb)
 /* Given a block of memory starting at BASE and SIZE bytes wide:
@@ -259,6 +303,7 @@ ik_munmap_from_segment (ikptr_t base, ikuword_t size, ikpcb_t* pcb)
 	free_cache_nodes	= next_free_node;
 	base			+= IK_PAGESIZE;
 	size			-= IK_PAGESIZE;
+	++(pcb->cached_pages_count);
       } while (free_cache_nodes && size);
       pcb->cached_pages   = used_cache_nodes;
       pcb->uncached_pages = free_cache_nodes;
@@ -521,10 +566,16 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
   gc_t			gc;
   ikmemblock_t *	old_full_heap_nursery_segments;
   int			requested_generation;
+  int			scheduled_generation;
+  ikuword_t		nursery_bytes;
 
   {
-    requested_generation = (IK_FALSE == s_requested_generation)?	\
-      collection_id_to_gen(pcb->collection_id) : IK_UNFIX(s_requested_generation);
+    if (IK_FALSE == s_requested_generation) {
+      scheduled_generation = (ik_gc_adaptive_schedule)? adaptive_generation(pcb) : collection_id_to_gen(pcb->collection_id);
+      requested_generation = postponed_generation(pcb, scheduled_generation);
+    } else {
+      scheduled_generation = requested_generation = IK_UNFIX(s_requested_generation);
+    }
     assert((0 <= requested_generation) && (requested_generation <= 4));
   }
   IK_RUNTIME_MESSAGE("%s: enter collection for generation %d, requested size %lu bytes, crossed redline=%s",
@@ -541,8 +592,8 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
   }
 
   { /* accounting */
-    ikuword_t bytes = ((ikuword_t)pcb->allocation_pointer) - ((ikuword_t)pcb->heap_nursery_hot_block_base);
-    register_to_collect_count(pcb, bytes);
+    nursery_bytes = ((ikuword_t)pcb->allocation_pointer) - ((ikuword_t)pcb->heap_nursery_hot_block_base);
+    register_to_collect_count(pcb, nursery_bytes);
   }
 
   { /* initialise GC statistics */
@@ -556,6 +607,7 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
   gc.segment_vector	= pcb->segment_vector;
   gc.collect_gen	= requested_generation;
   gc.collect_gen_tag	= NEXT_GEN_TAG[gc.collect_gen];
+  gc.scheduled_gen	= scheduled_generation;
   pcb->collection_id++;
 #if ((defined VICARE_DEBUGGING) && (defined VICARE_DEBUGGING_GC))
   ik_debug_message("ik_collect entry %ld free=%ld (collect gen=%d/id=%d)",
@@ -618,14 +670,25 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
 
   collect_loop(&gc);
 
-  /* Does  not  allocate,  only  sets  to  BWP  the  locations  of  dead
-     pointers. */
-  fix_weak_pointers(&gc);
+  { /* The sweeps  of the segments vector  visit every page in  the heap:
+       their cost is accounted separately. */
+    struct timeval	st0, st1;
+    gettimeofday(&st0, NULL);
+
+    /* Does  not  allocate,  only  sets  to  BWP  the  locations  of  dead
+       pointers. */
+    fix_weak_pointers(&gc);
+
+    /* Now deallocate all unused pages. */
+    deallocate_unused_pages(&gc);
 
-  /* Now deallocate all unused pages. */
-  deallocate_unused_pages(&gc);
+    fix_new_pages(&gc);
 
-  fix_new_pages(&gc);
+    gettimeofday(&st1, NULL);
+    gc.sweep_usecs = ((ikuword_t)(st1.tv_sec - st0.tv_sec)) * 1000000 + (st1.tv_usec - st0.tv_usec);
+    /* Every one of the three sweeps visits all the pages. */
+    gc.swept_pages = 3 * IK_PAGE_INDEX_RANGE(pcb->memory_end - pcb->memory_base);
+  }
   gc_finalize_guardians(&gc);
 
   /* does not allocate */
@@ -636,6 +699,11 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
   pcb->weak_pairs_ap = 0;
   pcb->weak_pairs_ep = 0;
 
+  /* Update  the schedule  state; this might  change the nursery  size, so
+     it must be done before preparing the new nursery hot block. */
+  register_survivors(&gc, nursery_bytes);
+  register_large_objects(&gc);
+
 #if ACCOUNTING
 #if ((defined VICARE_DEBUGGING) && (defined VICARE_DEBUGGING_GC))
   ik_debug_message("[%d cons|%d sym|%d cls|%d vec|%d rec|%d cck|%d str|%d htb]\n",
@@ -678,8 +746,10 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
    * we will succeed.
    *
    * If the  current nursery's hot  block is  big enough to  satisfy the
-   * request for memory: we reuse it;  otherwise we free the current hot
-   * block and we allocate a new one.
+   * request for memory and it has the  size selected for the nursery: we
+   * reuse it; otherwise we  free the current hot block and  we allocate a
+   * new one.  So a  block enlarged  for a big request,  or by the adaptive
+   * schedule, is given back when no longer needed.
    *
    * Notice that the neither the old block nor the newly allocated block
    * are initialised to  safe values (for example: reset  to zero, which
@@ -688,14 +758,15 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
   {
     pcb->allocation_pointer = pcb->heap_nursery_hot_block_base;
     iksword_t free_space = ((ikuword_t)pcb->allocation_redline) - ((ikuword_t)pcb->allocation_pointer);
-    if ((free_space <= mem_req) || (pcb->heap_nursery_hot_block_size < ik_customisable_heap_nursery_size)) {
-      ikuword_t		new_hot_block_size;
+    ikuword_t	target_size = nursery_target_size(pcb);
+    ikuword_t	new_hot_block_size;
+    if (mem_req > target_size) {
+      new_hot_block_size	= IK_ALIGN_TO_NEXT_PAGE(mem_req + IK_DOUBLE_PAGESIZE);
+    } else {
+      new_hot_block_size	= target_size;
+    }
+    if ((free_space <= mem_req) || (pcb->heap_nursery_hot_block_size != new_hot_block_size)) {
       ikptr_t		ap;
-      if (mem_req > ik_customisable_heap_nursery_size) {
-	new_hot_block_size	= IK_ALIGN_TO_NEXT_PAGE(mem_req + IK_DOUBLE_PAGESIZE);
-      } else {
-	new_hot_block_size	= ik_customisable_heap_nursery_size;
-      }
       /* Release the old nursery heap hot block. */
       ik_munmap_from_segment(pcb->heap_nursery_hot_block_base, pcb->heap_nursery_hot_block_size, pcb);
       /* Allocate new hot block. */
@@ -711,8 +782,8 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
     } else {
       IK_RUNTIME_MESSAGE("%s: reusing current heap's nursery hot block, size: %lu bytes, %lu pages",
 			   __func__,
-			   (ik_ulong)ik_customisable_heap_nursery_size,
-			   (ik_ulong)ik_customisable_heap_nursery_size/IK_PAGESIZE);
+			   (ik_ulong)pcb->heap_nursery_hot_block_size,
+			   (ik_ulong)pcb->heap_nursery_hot_block_size/IK_PAGESIZE);
     }
 #if ((defined VICARE_DEBUGGING) && (defined VICARE_DEBUGGING_GC))
     { /* Reset the free space to a magic number. */
@@ -723,6 +794,12 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
 #endif
   } /* Finished preparing new nursery heap hot block. */
 
+  /* Every  few  collections:  return  to  the OS  the  memory  of  cached
+     pages that were  not recycled in the meantime.  After  a peak in the
+     allocation rate this lets an idle process shrink back. */
+  if (0 == (pcb->collection_id % GC_PAGE_CACHE_DECAY_INTERVAL))
+    ik_decay_page_cache(pcb);
+
 #if (0 || (defined VICARE_GC_INTEGRITY) || (defined VICARE_DEBUGGING) && (defined VICARE_DEBUGGING_GC))
   verify_gc_integrity_option = 1;
 #endif
@@ -759,6 +836,15 @@ perform_garbage_collection (ikuword_t mem_req, ikptr_t s_requested_generation, i
       pcb->collect_rtime.tv_usec += 1000000;
       pcb->collect_rtime.tv_sec  -= 1;
     }
+    {
+      ikuword_t	real_usecs = ((ikuword_t)(rt1.tv_sec - rt0.tv_sec)) * 1000000 + (rt1.tv_usec - rt0.tv_usec);
+      ikuword_t	user_usecs = ((ikuword_t)(t1.ru_utime.tv_sec - t0.ru_utime.tv_sec)) * 1000000
+	+ (t1.ru_utime.tv_usec - t0.ru_utime.tv_usec);
+      ikuword_t	sys_usecs  = ((ikuword_t)(t1.ru_stime.tv_sec - t0.ru_stime.tv_sec)) * 1000000
+	+ (t1.ru_stime.tv_usec - t0.ru_stime.tv_usec);
+      register_pause_time(pcb, requested_generation, real_usecs);
+      log_collection(&gc, real_usecs, user_usecs, sys_usecs);
+    }
   }
   IK_RUNTIME_MESSAGE("%s: leave collection for generation %d",
 		     __func__, requested_generation);
@@ -783,6 +869,211 @@ collection_id_to_gen (int id)
   if ((id &   3) == 3)   { return 1; }	/*   3 == #b00000011 */
   return 0;
 }
+
+/* ------------------------------------------------------------------ */
+
+/* When "ik_gc_postponement_threshold_usecs"  is non-zero: an automatic
+ * collection of a generation whose last pause was longer than such number of
+ * microseconds is postponed, and  the collection of a younger generation is
+ * performed instead.
+ *
+ *   This is a scheduling heuristic, not a bound on pause times: every
+ * collection still runs to  completion, because the collector moves live
+ * objects and cannot  stop in the middle.  A postponed  collection is only
+ * moved to a later time, when it may have more data to copy.  A generation
+ * cannot be  postponed forever, otherwise  its garbage would  never be
+ * reclaimed: after GC_MAX_POSTPONED_COLLECTIONS postponed collections the
+ * scheduled generation is collected anyway.  Explicit calls to COLLECT with a
+ * generation argument are never postponed.
+ */
+#define GC_MAX_POSTPONED_COLLECTIONS	4
+
+static int
+postponed_generation (ikpcb_t * pcb, int scheduled_generation)
+/* Subroutine  of "perform_garbage_collection()".   Given the  generation
+   selected by the schedule for an automatic collection: return the
+   generation to be actually collected after postponing the slow ones. */
+{
+  int	gen = scheduled_generation;
+  if (ik_gc_postponement_threshold_usecs) {
+    for (; IK_GC_GENERATION_NURSERY < gen; --gen) {
+      if ((pcb->gc_last_pause_usecs[gen] <= ik_gc_postponement_threshold_usecs) ||
+	  (GC_MAX_POSTPONED_COLLECTIONS <= pcb->gc_postponed_collections[gen])) {
+	break;
+      } else {
+	++pcb->gc_postponed_collections[gen];
+      }
+    }
+    if (gen != scheduled_generation) {
+      IK_RUNTIME_MESSAGE("%s: postponed collection of generation %d, collecting generation %d",
+			 __func__, scheduled_generation, gen);
+    }
+  }
+  return gen;
+}
+static void
+register_pause_time (ikpcb_t * pcb, int collected_generation, ikuword_t pause_usecs)
+/* Subroutine of "perform_garbage_collection()".  Record the pause time of
+   a collection; collecting a generation also collects all the younger
+   ones, so their postponed collections are performed. */
+{
+  int	gen;
+  /* Average the new measurement with the old one, so that a single slow
+     or fast collection does not change the schedule too much. */
+  if (pcb->gc_last_pause_usecs[collected_generation]) {
+    pcb->gc_last_pause_usecs[collected_generation] = (pcb->gc_last_pause_usecs[collected_generation] + pause_usecs) / 2;
+  } else {
+    pcb->gc_last_pause_usecs[collected_generation] = pause_usecs;
+  }
+  for (gen=IK_GC_GENERATION_NURSERY; gen<=collected_generation; ++gen) {
+    pcb->gc_postponed_collections[gen] = 0;
+  }
+}
+
+/* ------------------------------------------------------------------ */
+
+/* When "ik_gc_adaptive_schedule" is  true: automatic collections select
+ * the generation  to collect from the  amount of data promoted into every
+ * generation,  rather than from  the collection counter.  It  is selected
+ * at start-up with the command line option "--option gc-schedule=adaptive".
+ *
+ *   Every collection of generation  N moves all the live objects of the
+ * generations from 0 to N into generation N+1 (the oldest generation is
+ * collected into  itself).  We keep  count of the bytes moved  into every
+ * generation since it was last collected: a generation is collected when
+ * such count is  above both the number of bytes  that survived its last
+ * collection and a  minimum amount; so the data in  a generation at most
+ * doubles between two collections of it.
+ *
+ *   The  nursery  size  is adapted, too:  after  a  collection  of the
+ * nursery, if more than 1/4 of the allocated bytes survived the nursery
+ * is enlarged, so that objects have more time to die before promotion; if
+ * less than 1/32  survived it is  shrunk back towards the size configured
+ * by the user.  The nursery is  never enlarged when its last pause time
+ * is already above the postponement threshold.  The adapted size is stored in
+ * the PCB,  so the  user setting  "ik_customisable_heap_nursery_size" is
+ * left untouched and it is always the lower bound.
+ *
+ *   All the state of the schedule is stored in the PCB, like the rest of
+ * the collector's state.
+ */
+#define GC_ADAPTIVE_NURSERY_GROWTH_LIMIT	16
+
+static int
+adaptive_generation (ikpcb_t * pcb)
+/* Subroutine  of "perform_garbage_collection()".  Select the generation
+   to collect using the adaptive schedule. */
+{
+  int	gen = IK_GC_GENERATION_NURSERY;
+  int	i;
+  for (i=1; i<IK_GC_GENERATION_COUNT; ++i) {
+    /* The minimum amount is  one nursery for generation 1, two nurseries
+       for generation 2, four for generation 3 and so on. */
+    ikuword_t	threshold = ik_customisable_heap_nursery_size << (i - 1);
+    if (threshold < pcb->gc_survived_bytes[i]) {
+      threshold = pcb->gc_survived_bytes[i];
+    }
+    if (pcb->gc_promoted_bytes[i] >= threshold) {
+      gen = i;
+    }
+  }
+  return gen;
+}
+static void
+register_survivors (gc_t * gc, ikuword_t nursery_bytes)
+/* Subroutine of "perform_garbage_collection()".  Update the state of the
+   adaptive schedule after a collection; NURSERY_BYTES is the number of
+   bytes that were allocated in the nursery hot block. */
+{
+  ikpcb_t *	pcb      = gc->pcb;
+  int		gen      = gc->collect_gen;
+  ikuword_t	survived = gc->large_object_bytes;
+  int		i;
+  for (i=0; i<meta_count; ++i) {
+    survived += gc->copied_bytes[i];
+  }
+  for (i=IK_GC_GENERATION_NURSERY; i<=gen; ++i) {
+    pcb->gc_promoted_bytes[i] = 0;
+  }
+  if (gen < IK_GC_GENERATION_OLDEST) {
+    pcb->gc_promoted_bytes[gen+1] += survived;
+  }
+  pcb->gc_survived_bytes[gen] = survived;
+  if (ik_gc_adaptive_schedule && (IK_GC_GENERATION_NURSERY == gen) && nursery_bytes) {
+    ikuword_t	size = nursery_target_size(pcb);
+    ikuword_t	max_size = GC_ADAPTIVE_NURSERY_GROWTH_LIMIT * ik_customisable_heap_nursery_size;
+    if ((survived > (nursery_bytes / 4)) &&
+	(size < max_size) &&
+	((0 == ik_gc_postponement_threshold_usecs) || (pcb->gc_last_pause_usecs[gen] < ik_gc_postponement_threshold_usecs))) {
+      pcb->adaptive_heap_nursery_size = 2 * size;
+      IK_RUNTIME_MESSAGE("%s: enlarging heap nursery to %lu bytes", __func__,
+			 (ik_ulong)pcb->adaptive_heap_nursery_size);
+    } else if ((survived < (nursery_bytes / 32)) && (size > ik_customisable_heap_nursery_size)) {
+      size /= 2;
+      pcb->adaptive_heap_nursery_size = (size < ik_customisable_heap_nursery_size)? 0 : IK_ALIGN_TO_NEXT_PAGE(size);
+      IK_RUNTIME_MESSAGE("%s: shrinking heap nursery to %lu bytes", __func__,
+			 (ik_ulong)nursery_target_size(pcb));
+    }
+  }
+}
+static ikuword_t
+nursery_target_size (ikpcb_t * pcb)
+/* Subroutine of "perform_garbage_collection()".  Return the size in bytes
+   of the nursery hot block to allocate after a collection: the size
+   selected by  the adaptive schedule, if any, bounded by  the size
+   configured by the user. */
+{
+  ikuword_t	size = ik_customisable_heap_nursery_size;
+  if (ik_gc_adaptive_schedule && pcb->adaptive_heap_nursery_size) {
+    ikuword_t	max_size = GC_ADAPTIVE_NURSERY_GROWTH_LIMIT * ik_customisable_heap_nursery_size;
+    if (pcb->adaptive_heap_nursery_size > max_size) {
+      size = max_size;
+    } else if (pcb->adaptive_heap_nursery_size > size) {
+      size = pcb->adaptive_heap_nursery_size;
+    }
+  }
+  return size;
+}
+
+/* ------------------------------------------------------------------ */
+
+/* Objects  whose data area  is at least  one page (vectors)  or at least
+ * GC_LARGE_DATA_MIN_SIZE  bytes (strings  and  bytevectors) are  moved, the
+ * first time they survive a collection, into a run of pages of their own
+ * marked with  LARGE_OBJECT_TAG in the segments  vector: the large object
+ * space.  From then on they are promoted by retagging their pages, never
+ * copied again.
+ *
+ *   We keep  the number of such  objects, and of  the bytes of  their page
+ * runs, for every generation; the totals are stored in the PCB and made
+ * available to Scheme code by "ikrt_stats_now()".
+ */
+static ikuword_t	large_objects_count[IK_GC_GENERATION_COUNT];
+static ikuword_t	large_objects_bytes[IK_GC_GENERATION_COUNT];
+
+static void
+register_large_objects (gc_t * gc)
+/* Subroutine of "perform_garbage_collection()".  Every large object in the
+   collected generations has either  died or has been moved  into the target
+   generation. */
+{
+  int		target = gc->collect_gen_tag & OLD_GEN_MASK;
+  ikuword_t	count  = 0;
+  ikuword_t	bytes  = 0;
+  int		i;
+  for (i=IK_GC_GENERATION_NURSERY; i<=gc->collect_gen; ++i) {
+    large_objects_count[i] = 0;
+    large_objects_bytes[i] = 0;
+  }
+  large_objects_count[target] += gc->large_objects_count;
+  large_objects_bytes[target] += gc->large_objects_bytes;
+  for (i=0; i<IK_GC_GENERATION_COUNT; ++i) {
+    count += large_objects_count[i];
+    bytes += large_objects_bytes[i];
+  }
+  gc->pcb->large_objects_count = count;
+  gc->pcb->large_objects_bytes = bytes;
+}
 static inline void
 collect_locatives (gc_t* gc, ik_callback_locative_t* loc)
 /* Subroutine of "perform_garbage_collection()". */
@@ -906,6 +1197,7 @@ gc_finalize_guardians (gc_t* gc)
     ik_munmap((ikptr_t)ls, IK_PAGESIZE);
     ls = next;
   }
+  gc->finalized_objects = tconc_count;
 }
 
 
@@ -1293,6 +1585,7 @@ handle_guardians (gc_t* gc)
     while (prot_list) {
       int	i;
       /* Scan the words in this page. */
+      gc->guarded_objects += prot_list->count;
       for(i=0; i<prot_list->count; i++) {
         ikptr_t	p   = prot_list->ptr[i];
         ikptr_t	tc  = IK_CAR(p);
@@ -1443,6 +1736,8 @@ static inline ikptr_t	gc_alloc_new_data	(ikuword_t aligned_size, gc_t* gc);
 static inline ikptr_t	gc_alloc_new_ptr	(ikuword_t aligned_size, gc_t* gc);
 static inline ikptr_t	gc_alloc_new_large_ptr	(ikuword_t number_of_bytes, gc_t* gc);
 static inline void	enqueue_large_ptr	(ikptr_t mem, ikuword_t aligned_size, gc_t* gc);
+static inline ikptr_t	gc_alloc_new_large_data	(ikuword_t number_of_bytes, gc_t* gc);
+static inline void	retag_large_data	(ikptr_t mem, ikuword_t number_of_bytes, gc_t* gc);
 static inline ikptr_t	gc_alloc_new_symbol_record (gc_t* gc);
 static inline ikptr_t	gc_alloc_new_pair	(gc_t* gc);
 static inline ikptr_t	gc_alloc_new_weak_pair	(gc_t* gc);
@@ -2043,7 +2338,17 @@ gather_live_object_proc (gc_t* gc, ikptr_t X)
     if (IK_IS_FIXNUM(first_word)) {
       ikuword_t	len    = IK_UNFIX(first_word);
       ikuword_t	memreq = IK_ALIGN(len * IK_STRING_CHAR_SIZE + disp_string_data);
-      ikptr_t	Y      = gc_alloc_new_data(memreq, gc) | string_tag;
+      ikptr_t	Y;
+      if (memreq >= GC_LARGE_DATA_MIN_SIZE) {
+	if (LARGE_OBJECT_TAG == (page_sbits & LARGE_OBJECT_MASK)) {
+	  /* Big string already in the large object space: promote it in
+	     place. */
+	  retag_large_data(X - string_tag, memreq, gc);
+	  return X;
+	} else
+	  Y = gc_alloc_new_large_data(memreq, gc) | string_tag;
+      } else
+	Y = gc_alloc_new_data(memreq, gc) | string_tag;
       IK_REF(Y, off_string_length) = first_word;
       memcpy((uint8_t*)(ikuword_t)(Y + off_string_data),
              (uint8_t*)(ikuword_t)(X + off_string_data),
@@ -2061,7 +2366,17 @@ gather_live_object_proc (gc_t* gc, ikptr_t X)
   case bytevector_tag: {
     ikuword_t	len    = IK_UNFIX(first_word);
     ikuword_t	memreq = IK_ALIGN(len + disp_bytevector_data + 1);
-    ikptr_t	Y = gc_alloc_new_data(memreq, gc) | bytevector_tag;
+    ikptr_t	Y;
+    if (memreq >= GC_LARGE_DATA_MIN_SIZE) {
+      if (LARGE_OBJECT_TAG == (page_sbits & LARGE_OBJECT_MASK)) {
+	/* Big bytevector  already in the large  object space: promote it
+	   in place. */
+	retag_large_data(X - bytevector_tag, memreq, gc);
+	return X;
+      } else
+	Y = gc_alloc_new_large_data(memreq, gc) | bytevector_tag;
+    } else
+      Y = gc_alloc_new_data(memreq, gc) | bytevector_tag;
     IK_REF(Y, off_bytevector_length) = first_word;
     memcpy((uint8_t*)(ikuword_t)(Y + off_bytevector_data),
            (uint8_t*)(ikuword_t)(X + off_bytevector_data),
@@ -2497,6 +2812,9 @@ gc_alloc_new_large_ptr (ikuword_t number_of_bytes, gc_t* gc)
   ikptr_t		mem;
   memreq = IK_ALIGN_TO_NEXT_PAGE(number_of_bytes);
   mem    = ik_mmap_typed(memreq, POINTERS_MT | LARGE_OBJECT_TAG | gc->collect_gen_tag, gc->pcb);
+  gc->copied_bytes[meta_ptrs] += number_of_bytes;
+  ++(gc->large_objects_count);
+  gc->large_objects_bytes += memreq;
   /* Reset to zero  the portion of memory  that will not be  used by the
      large object. */
   bzero((uint8_t*)(ikuword_t)(mem+number_of_bytes), memreq-number_of_bytes);
@@ -2525,6 +2843,9 @@ enqueue_large_ptr (ikptr_t mem, ikuword_t aligned_size, gc_t* gc)
 {
   ikuword_t	page_idx = IK_PAGE_INDEX(mem);
   ikuword_t	page_end = IK_PAGE_INDEX(mem+aligned_size-1);
+  gc->large_object_bytes += aligned_size;
+  ++(gc->large_objects_count);
+  gc->large_objects_bytes += IK_ALIGN_TO_NEXT_PAGE(aligned_size);
   for (; page_idx <= page_end; ++page_idx) {
     gc->segment_vector[page_idx] = POINTERS_MT | LARGE_OBJECT_TAG | gc->collect_gen_tag;
   }
@@ -2538,6 +2859,43 @@ enqueue_large_ptr (ikptr_t mem, ikuword_t aligned_size, gc_t* gc)
   }
 }
 static inline ikptr_t
+gc_alloc_new_large_data (ikuword_t number_of_bytes, gc_t* gc)
+/* Alloc memory pages  in which a large string or  bytevector will be
+   stored; return a  pointer to the first allocated page.   The pages are
+   marked in the segments vector as "large object", this will prevent later
+   such object to be copied around.  Data objects are not scanned, so there
+   is nothing to enqueue. */
+{
+  ikuword_t	memreq = IK_ALIGN_TO_NEXT_PAGE(number_of_bytes);
+  ikptr_t	mem    = ik_mmap_typed(memreq, DATA_MT | LARGE_OBJECT_TAG | gc->collect_gen_tag, gc->pcb);
+  gc->copied_bytes[meta_data] += number_of_bytes;
+  ++(gc->large_objects_count);
+  gc->large_objects_bytes += memreq;
+  /* Reset to zero  the portion of memory  that will not be  used by the
+     large object. */
+  bzero((uint8_t*)(ikuword_t)(mem+number_of_bytes), memreq-number_of_bytes);
+  /* Retake   the   segments   vector  because   memory   allocated   by
+     "ik_mmap_typed()" might  have caused  the reallocation of  the page
+     vectors. */
+  gc->segment_vector = gc->pcb->segment_vector;
+  return mem;
+}
+static inline void
+retag_large_data (ikptr_t mem, ikuword_t number_of_bytes, gc_t* gc)
+/* Assume that  MEM references a large  string or bytevector  already stored
+   in memory pages marked as "large object".  Promote it to the target
+   generation by retagging its pages: its data area is not touched. */
+{
+  ikuword_t	page_idx = IK_PAGE_INDEX(mem);
+  ikuword_t	page_end = IK_PAGE_INDEX(mem+number_of_bytes-1);
+  gc->large_object_bytes += number_of_bytes;
+  ++(gc->large_objects_count);
+  gc->large_objects_bytes += IK_ALIGN_TO_NEXT_PAGE(number_of_bytes);
+  for (; page_idx <= page_end; ++page_idx) {
+    gc->segment_vector[page_idx] = DATA_MT | LARGE_OBJECT_TAG | gc->collect_gen_tag;
+  }
+}
+static inline ikptr_t
 gc_alloc_new_symbol_record (gc_t* gc)
 /* Reserve enough  room in the current  meta page for symbols  to hold a
    Scheme symbol's record.  Return an untagged pointer to the first word
@@ -2570,6 +2928,7 @@ gc_alloc_new_weak_pair(gc_t* gc)
   ikptr_t		ap  = meta->ap;		/* meta page alloc pointer */
   ikptr_t		ep  = meta->ep;		/* meta page end pointer */
   ikptr_t		nap = ap + pair_size;	/* meta page new alloc pointer */
+  gc->copied_bytes[meta_weak] += pair_size;
   if (nap > ep) {
     /* There is not  enough room, in the current meta  page, for another
        pair; we have to allocate a new page. */
@@ -2614,6 +2973,7 @@ gc_alloc_new_code (ikuword_t aligned_size, gc_t* gc)
   } else { /* More than one page needed. */
     ikuword_t	memreq	= IK_ALIGN_TO_NEXT_PAGE(aligned_size);
     ikptr_t	mem	= ik_mmap_code(memreq, gc->collect_gen, gc->pcb);
+    gc->copied_bytes[meta_code] += aligned_size;
     /* Reset to  zero the portion of  allocated memory that will  not be
        used by the code object. */
     bzero((char*)(ikuword_t)(mem+aligned_size), memreq-aligned_size);
@@ -2647,6 +3007,7 @@ meta_alloc (ikuword_t aligned_size, gc_t* gc, int meta_id)
   ikptr_t		ap   = meta->ap;		/* allocation pointer */
   ikptr_t		ep   = meta->ep;		/* end pointer */
   ikptr_t		nap  = ap + aligned_size;	/* new alloc pointer */
+  gc->copied_bytes[meta_id] += aligned_size;
   if (nap > ep) {
     /* Not enough room. */
     return meta_alloc_extending(aligned_size, gc, meta_id);
@@ -3022,6 +3383,46 @@ static const uint32_t CLEANUP_MASK[IK_GC_GENERATION_COUNT] = {
 
 static void scan_dirty_code_page     (gc_t* gc, ikuword_t page_idx);
 static void scan_dirty_pointers_page (gc_t* gc, ikuword_t page_idx, uint32_t mask);
+static void scan_dirty_page          (gc_t* gc, ikuword_t page_idx, uint32_t mask);
+
+/* Number  of dirty  vector  slots inspected  at once  while looking for
+ * pages with dirty cards.
+ *
+ *   Most of the pages in the  old generations are clean, so rather than
+ * testing  one slot  at a  time  we OR  together a  block of  slots and
+ * test the result against the  mask: only blocks holding at least one
+ * dirty card are inspected page by page.  Notice that we cannot keep a
+ * summary bitmap of  dirty blocks, because compiled Scheme  code marks
+ * the dirty vector directly (see the core primitive operations "$set-car!"
+ * and  friends);  the block  test  must  be  performed  on the  dirty
+ * vector itself.
+ */
+#define DIRTY_SCAN_BLOCK_SLOTS	8
+
+static inline int
+dirty_block_is_clean (const uint32_t * dirty_slots, uint32_t mask)
+/* Return true  if none of  the DIRTY_SCAN_BLOCK_SLOTS slots  starting at
+   DIRTY_SLOTS  has  a card  marked as  dirty  under  MASK.  The  slots
+   pointer is not required to be aligned. */
+{
+#if (defined __AVX2__)
+  __m256i	acc = _mm256_loadu_si256((const __m256i *)dirty_slots);
+  acc = _mm256_and_si256(acc, _mm256_set1_epi32((int)mask));
+  return _mm256_testz_si256(acc, acc);
+#elif (defined __SSE2__)
+  __m128i	acc = _mm_or_si128(_mm_loadu_si128((const __m128i *)dirty_slots),
+				   _mm_loadu_si128((const __m128i *)(dirty_slots + 4)));
+  acc = _mm_and_si128(acc, _mm_set1_epi32((int)mask));
+  return (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())));
+#else
+  uint32_t	acc = 0;
+  int		i;
+  for (i=0; i<DIRTY_SCAN_BLOCK_SLOTS; ++i) {
+    acc |= dirty_slots[i];
+  }
+  return (0 == (acc & mask));
+#endif
+}
 
 static void
 scan_dirty_pages (gc_t* gc)
@@ -3041,45 +3442,53 @@ scan_dirty_pages (gc_t* gc)
   ikpcb_t *	pcb         = gc->pcb;
   ikuword_t	lo_idx      = IK_PAGE_INDEX(pcb->memory_base);
   ikuword_t	hi_idx      = IK_PAGE_INDEX(pcb->memory_end);
-  uint32_t *	dirty_vec   = (uint32_t*)pcb->dirty_vector;
-  uint32_t *	segment_vec = pcb->segment_vector;
-  uint32_t	collect_gen = gc->collect_gen;
-  uint32_t	mask        = DIRTY_MASK[collect_gen];
-  ikuword_t	page_idx;
-  for (page_idx = lo_idx; page_idx < hi_idx; ++page_idx) {
-    if (dirty_vec[page_idx] & mask) {
-      uint32_t page_bits               = segment_vec[page_idx];
-      uint32_t page_generation_number  = page_bits & GEN_MASK;
-      if (page_generation_number > collect_gen) {
-        uint32_t type = page_bits & TYPE_MASK;
-        if (type == POINTERS_TYPE) {
-          scan_dirty_pointers_page(gc, page_idx, mask);
-          dirty_vec   = (uint32_t*)pcb->dirty_vector;
-          segment_vec = pcb->segment_vector;
-        }
-        else if (type == SYMBOLS_TYPE) {
-          scan_dirty_pointers_page(gc, page_idx, mask);
-          dirty_vec   = (uint32_t*)pcb->dirty_vector;
-          segment_vec = pcb->segment_vector;
-        }
-        else if (type == WEAK_PAIRS_TYPE) {
-          scan_dirty_pointers_page(gc, page_idx, mask);
-          dirty_vec   = (uint32_t*)pcb->dirty_vector;
-          segment_vec = pcb->segment_vector;
-        }
-        else if (type == CODE_TYPE) {
-          scan_dirty_code_page(gc, page_idx);
-          dirty_vec   = (uint32_t*)pcb->dirty_vector;
-          segment_vec = pcb->segment_vector;
-        }
-        else if (page_bits & SCANNABLE_MASK) {
-          ik_abort("unhandled dirty scan for page with segment bits 0x%08x", page_bits);
-	}
+  uint32_t	mask        = DIRTY_MASK[gc->collect_gen];
+  ikuword_t	page_idx    = lo_idx;
+  /* When collecting  the oldest generation no page  can reference objects
+     in a non-collected younger generation. */
+  if (0 == mask) {
+    return;
+  }
+  while (page_idx < hi_idx) {
+    ikuword_t	block_end = page_idx + DIRTY_SCAN_BLOCK_SLOTS;
+    if (block_end > hi_idx) {
+      block_end = hi_idx;
+    } else if (dirty_block_is_clean(((uint32_t*)pcb->dirty_vector) + page_idx, mask)) {
+      page_idx = block_end;
+      continue;
+    }
+    /* Scanning a  page might reallocate the dirty  vector, so we retake
+       it at every iteration. */
+    for (; page_idx < block_end; ++page_idx) {
+      if (((uint32_t*)pcb->dirty_vector)[page_idx] & mask) {
+	scan_dirty_page(gc, page_idx, mask);
       }
     }
   }
 }
 static void
+scan_dirty_page (gc_t* gc, ikuword_t page_idx, uint32_t mask)
+/* Subroutine of "scan_dirty_pages()".  Scan the page at PAGE_IDX, whose
+   dirty vector slot has at least one card marked as dirty under MASK. */
+{
+  uint32_t	page_bits               = gc->pcb->segment_vector[page_idx];
+  uint32_t	page_generation_number  = page_bits & GEN_MASK;
+  if (page_generation_number > (uint32_t)gc->collect_gen) {
+    uint32_t type = page_bits & TYPE_MASK;
+    if ((type == POINTERS_TYPE) || (type == SYMBOLS_TYPE) || (type == WEAK_PAIRS_TYPE)) {
+      ++(gc->dirty_pages);
+      scan_dirty_pointers_page(gc, page_idx, mask);
+    }
+    else if (type == CODE_TYPE) {
+      ++(gc->dirty_pages);
+      scan_dirty_code_page(gc, page_idx);
+    }
+    else if (page_bits & SCANNABLE_MASK) {
+      ik_abort("unhandled dirty scan for page with segment bits 0x%08x", page_bits);
+    }
+  }
+}
+static void
 scan_dirty_pointers_page (gc_t* gc, ikuword_t page_idx, uint32_t mask)
 /* Subroutine of "scan_dirty_pages()".  It is  used to scan a dirty page
    containing  the data  area of  Scheme objects  composed of  immediate
@@ -3195,6 +3604,205 @@ scan_dirty_code_page (gc_t* gc, ikuword_t page_idx)
 }
 
 
+/** --------------------------------------------------------------------
+ ** Garbage collection event log.
+ ** ----------------------------------------------------------------- */
+
+/* Every  collection appends an  event to  a ring buffer  holding the last
+ * GC_EVENT_LOG_SIZE events; the events are read from Scheme by the function
+ * GC-EVENT-LOG in "ikarus.timer.sls".  The events are numbered with the
+ * collection  counter: the event with  number N is stored in the slot at
+ * index (N % GC_EVENT_LOG_SIZE).
+ *
+ *   If "gc_event_log_fd" is non-negative: every event  is also written to
+ * such file descriptor as a line of JSON text.  The writing is not done by
+ * the collector: the file descriptor is selected by the user, and a pipe or
+ * socket whose reader stalls would freeze the collection.  The events are
+ * written by "ikrt_gc_event_log_flush()", which is called by Scheme code
+ * after the collection has returned; events that left the ring buffer
+ * before being written are lost.
+ */
+#define GC_EVENT_LOG_SIZE	256
+
+typedef struct gc_event_t {
+  ikuword_t	collection_id;
+  int		generation;
+  ikuword_t	real_usecs;
+  ikuword_t	user_usecs;
+  ikuword_t	sys_usecs;
+  ikuword_t	copied_bytes[meta_count];
+  ikuword_t	large_object_bytes;
+  ikuword_t	promoted_bytes;
+  ikuword_t	dirty_pages;
+  ikuword_t	guarded_objects;
+  ikuword_t	finalized_objects;
+  ikuword_t	sweep_usecs;
+  ikuword_t	swept_pages;
+  int		scheduled_generation;
+} gc_event_t;
+
+static gc_event_t	gc_event_log[GC_EVENT_LOG_SIZE];
+
+/* The number of the first event stored in the ring buffer and the number
+   of the event that will be stored next. */
+static ikuword_t	gc_event_log_first = 0;
+static ikuword_t	gc_event_log_past  = 0;
+
+static int		gc_event_log_fd = -1;
+
+/* The number of the first event not yet written to "gc_event_log_fd". */
+static ikuword_t	gc_event_log_written = 0;
+
+static void
+log_collection (gc_t * gc, ikuword_t real_usecs, ikuword_t user_usecs, ikuword_t sys_usecs)
+/* Subroutine of "perform_garbage_collection()".  Append to the event log
+   an event describing the collection represented by GC. */
+{
+  ikpcb_t *	pcb = gc->pcb;
+  gc_event_t *	E;
+  ikuword_t	survived = gc->large_object_bytes;
+  int		i;
+  if (0 == gc_event_log_past) {
+    /* First collection: the event numbers start from the collection
+       counter. */
+    gc_event_log_first = gc_event_log_past = (ikuword_t)pcb->collection_id;
+  }
+  E = &gc_event_log[gc_event_log_past % GC_EVENT_LOG_SIZE];
+  E->collection_id	= (ikuword_t)pcb->collection_id;
+  E->generation		= gc->collect_gen;
+  E->real_usecs		= real_usecs;
+  E->user_usecs		= user_usecs;
+  E->sys_usecs		= sys_usecs;
+  for (i=0; i<meta_count; ++i) {
+    E->copied_bytes[i]	= gc->copied_bytes[i];
+    survived		+= gc->copied_bytes[i];
+  }
+  E->large_object_bytes	= gc->large_object_bytes;
+  E->promoted_bytes	= (gc->collect_gen < IK_GC_GENERATION_OLDEST)? survived : 0;
+  E->dirty_pages	= gc->dirty_pages;
+  E->guarded_objects	= gc->guarded_objects;
+  E->finalized_objects	= gc->finalized_objects;
+  E->sweep_usecs	= gc->sweep_usecs;
+  E->swept_pages	= gc->swept_pages;
+  E->scheduled_generation = gc->scheduled_gen;
+  ++gc_event_log_past;
+  if (GC_EVENT_LOG_SIZE < (gc_event_log_past - gc_event_log_first)) {
+    ++gc_event_log_first;
+  }
+}
+static int
+write_event (gc_event_t * E)
+/* Subroutine of "ikrt_gc_event_log_flush()".  Write the event E to
+   "gc_event_log_fd" as a line of JSON text; return false if writing
+   failed. */
+{
+  char	line[512];
+  int	len;
+  len = snprintf(line, sizeof(line),
+		 "{\"collection_id\":%lu,\"generation\":%d,"
+		 "\"real_usecs\":%lu,\"user_usecs\":%lu,\"sys_usecs\":%lu,"
+		 "\"copied_bytes\":{\"pointers\":%lu,\"code\":%lu,\"data\":%lu,"
+		 "\"weak_pairs\":%lu,\"pairs\":%lu,\"symbols\":%lu},"
+		 "\"large_object_bytes\":%lu,\"promoted_bytes\":%lu,\"dirty_pages\":%lu,"
+		 "\"guarded_objects\":%lu,\"finalized_objects\":%lu,"
+		 "\"sweep_usecs\":%lu,\"swept_pages\":%lu,\"scheduled_generation\":%d}\n",
+		 (ik_ulong)E->collection_id, E->generation,
+		 (ik_ulong)E->real_usecs, (ik_ulong)E->user_usecs, (ik_ulong)E->sys_usecs,
+		 (ik_ulong)E->copied_bytes[meta_ptrs], (ik_ulong)E->copied_bytes[meta_code],
+		 (ik_ulong)E->copied_bytes[meta_data], (ik_ulong)E->copied_bytes[meta_weak],
+		 (ik_ulong)E->copied_bytes[meta_pair], (ik_ulong)E->copied_bytes[meta_symbol],
+		 (ik_ulong)E->large_object_bytes, (ik_ulong)E->promoted_bytes,
+		 (ik_ulong)E->dirty_pages, (ik_ulong)E->guarded_objects,
+		 (ik_ulong)E->finalized_objects,
+		 (ik_ulong)E->sweep_usecs, (ik_ulong)E->swept_pages, E->scheduled_generation);
+  if ((0 < len) && (len < (int)sizeof(line))) {
+    return (write(gc_event_log_fd, line, len) == len);
+  } else {
+    return 0;
+  }
+}
+
+/* ------------------------------------------------------------------ */
+
+ikptr_t
+ikrt_gc_event_log_first (ikpcb_t * pcb)
+{
+  return IK_FIX(gc_event_log_first);
+}
+ikptr_t
+ikrt_gc_event_log_past (ikpcb_t * pcb)
+{
+  return IK_FIX(gc_event_log_past);
+}
+ikptr_t
+ikrt_gc_event_log_ref (ikptr_t s_event_number, ikptr_t s_event, ikpcb_t * pcb)
+/* Fill the fields of the  Scheme record S_EVENT with the values from the
+   event S_EVENT_NUMBER; return true if  the event is still in the ring
+   buffer, otherwise return false and leave S_EVENT untouched.
+
+   Do not  change the order of  the fields!!!  It must match  the record
+   type "gc-event" in "scheme/ikarus.timer.sls". */
+{
+  ikuword_t	event_number = IK_UNFIX(s_event_number);
+  if ((gc_event_log_first <= event_number) && (event_number < gc_event_log_past)) {
+    gc_event_t *	E = &gc_event_log[event_number % GC_EVENT_LOG_SIZE];
+    IK_FIELD(s_event,  0) = IK_FIX(E->collection_id);
+    IK_FIELD(s_event,  1) = IK_FIX(E->generation);
+    IK_FIELD(s_event,  2) = IK_FIX(E->real_usecs);
+    IK_FIELD(s_event,  3) = IK_FIX(E->user_usecs);
+    IK_FIELD(s_event,  4) = IK_FIX(E->sys_usecs);
+    IK_FIELD(s_event,  5) = IK_FIX(E->copied_bytes[meta_ptrs]);
+    IK_FIELD(s_event,  6) = IK_FIX(E->copied_bytes[meta_code]);
+    IK_FIELD(s_event,  7) = IK_FIX(E->copied_bytes[meta_data]);
+    IK_FIELD(s_event,  8) = IK_FIX(E->copied_bytes[meta_weak]);
+    IK_FIELD(s_event,  9) = IK_FIX(E->copied_bytes[meta_pair]);
+    IK_FIELD(s_event, 10) = IK_FIX(E->copied_bytes[meta_symbol]);
+    IK_FIELD(s_event, 11) = IK_FIX(E->large_object_bytes);
+    IK_FIELD(s_event, 12) = IK_FIX(E->promoted_bytes);
+    IK_FIELD(s_event, 13) = IK_FIX(E->dirty_pages);
+    IK_FIELD(s_event, 14) = IK_FIX(E->guarded_objects);
+    IK_FIELD(s_event, 15) = IK_FIX(E->finalized_objects);
+    IK_FIELD(s_event, 16) = IK_FIX(E->sweep_usecs);
+    IK_FIELD(s_event, 17) = IK_FIX(E->swept_pages);
+    IK_FIELD(s_event, 18) = IK_FIX(E->scheduled_generation);
+    return IK_TRUE;
+  } else {
+    return IK_FALSE;
+  }
+}
+ikptr_t
+ikrt_gc_event_log_fd_ref (ikpcb_t * pcb)
+{
+  return (0 <= gc_event_log_fd)? IK_FIX(gc_event_log_fd) : IK_FALSE;
+}
+ikptr_t
+ikrt_gc_event_log_fd_set (ikptr_t s_fd, ikpcb_t * pcb)
+{
+  gc_event_log_fd = (IK_FALSE == s_fd)? -1 : IK_UNFIX(s_fd);
+  /* Only the events of the collections from now on are written. */
+  gc_event_log_written = gc_event_log_past;
+  return IK_VOID;
+}
+ikptr_t
+ikrt_gc_event_log_flush (ikpcb_t * pcb)
+/* Write to "gc_event_log_fd" the events not yet written that are still in
+   the ring buffer.  Errors are ignored: the log is a diagnostic facility,
+   it must not break the program; when writing fails the pending events are
+   dropped. */
+{
+  if (0 <= gc_event_log_fd) {
+    ikuword_t	event_number = (gc_event_log_written < gc_event_log_first)? gc_event_log_first : gc_event_log_written;
+    for (; event_number < gc_event_log_past; ++event_number) {
+      if (! write_event(&gc_event_log[event_number % GC_EVENT_LOG_SIZE])) {
+	break;
+      }
+    }
+  }
+  gc_event_log_written = gc_event_log_past;
+  return IK_VOID;
+}
+
+
 /** --------------------------------------------------------------------
  ** Miscellaneous functions.
  ** ----------------------------------------------------------------- */
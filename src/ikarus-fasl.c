@@ -66,6 +66,7 @@ static int	object_count = 0;
 /* ------------------------------------------------------------------ */
 
 static ikptr_t	fasl_read_super_code_object(ikpcb_t * pcb, fasl_port_t* p);
+static void *	foreign_address (const char * name);
 static ikptr_t	do_read (ikpcb_t * pcb, fasl_port_t* p);
 static ikptr_t	alloc_code_object (ikuword_t scheme_object_size, ikpcb_t * pcb, fasl_port_t* p);
 static uint8_t	fasl_read_byte (fasl_port_t* p);
@@ -108,6 +109,12 @@ ik_fasl_load (ikpcb_t * pcb, const char * fasl_file)
     mem		= mmap(0, mapsize, PROT_READ, MAP_PRIVATE, fd, 0);
     if (MAP_FAILED == mem)
       ik_abort("mapping failed for %s: %s", fasl_file, strerror(errno));
+#if ((defined HAVE_MADVISE) && (defined MADV_WILLNEED))
+    /* We  are going  to read  the whole  file  sequentially: start  the
+       read-ahead of all of it now, rather than faulting one page at a
+       time. */
+    madvise(mem, mapsize, MADV_WILLNEED);
+#endif
   }
 
   /* Initialise the "fasl_port_t" struct. */
@@ -971,22 +978,12 @@ ik_relocate_code (ikptr_t p_code)
 	 the data area. */
       ikptr_t	s_str	= IK_RELOC_RECORD_2ND(p_reloc_vec_cur);
       char *	name	= NULL;
-      void *	sym;
-      char *	err;
       if (IK_TAGOF(s_str) == bytevector_tag) {
         name = IK_BYTEVECTOR_DATA_CHARP(s_str);
       } else {
         ik_abort("foreign name is not a bytevector");
       }
-      /* We  call  "dlerror()"  here   to  clean  up  possible  previous
-	 errors. */
-      dlerror();
-      sym = dlsym(RTLD_DEFAULT, name);
-      err = dlerror();
-      if (err) {
-        ik_abort("dlsym() failed to find foreign name %s: %s", name, err);
-      }
-      IK_REF(p_data, data_area_displacement) = (ikptr_t)sym;
+      IK_REF(p_data, data_area_displacement) = (ikptr_t)foreign_address(name);
       p_reloc_vec_cur += (2*wordsize);
       break;
     }
@@ -998,6 +995,87 @@ ik_relocate_code (ikptr_t p_code)
   } /* end of while() */
 }
 
+
+/* Cache  of the  addresses of  C  language functions  referenced by  code
+ * objects.  The boot image holds thousands of relocation records naming
+ * the same few hundred  "ikrt_*()" functions, and "dlsym()"  with a default
+ * handle searches  all the loaded shared  objects every time; the cache
+ * saves the repeated lookups.
+ *
+ *   Only successful  lookups are cached.  With  RTLD_DEFAULT the first
+ * object defining a symbol wins, and shared objects loaded later come
+ * after the ones already loaded, so loading a library cannot make a cached
+ * address stale; closing  one can, because it  may unload the library:
+ * "ikrt_dlclose()" flushes the whole cache.  When the table is full we
+ * just call "dlsym()".
+ */
+#define FOREIGN_ADDRESS_CACHE_SIZE	4096	/* must be a power of 2 */
+
+typedef struct foreign_address_t {
+  char *	name;	/* NULL if the slot is free */
+  void *	address;
+} foreign_address_t;
+
+static foreign_address_t	foreign_address_cache[FOREIGN_ADDRESS_CACHE_SIZE];
+static int			foreign_address_cache_count = 0;
+
+static void *
+foreign_address (const char * name)
+/* Return the address of the C language function NAME; abort if not found. */
+{
+  uint32_t	hash = 2166136261u;	/* 32-bit FNV-1a */
+  ikuword_t	idx;
+  void *	sym;
+  char *	err;
+  {
+    const uint8_t *	ch;
+    for (ch = (const uint8_t *)name; *ch; ++ch) {
+      hash = (hash ^ *ch) * 16777619u;
+    }
+  }
+  /* Linear probing; we stop at the first free slot. */
+  for (idx = hash & (FOREIGN_ADDRESS_CACHE_SIZE - 1);
+       foreign_address_cache[idx].name;
+       idx = (idx + 1) & (FOREIGN_ADDRESS_CACHE_SIZE - 1)) {
+    if (0 == strcmp(foreign_address_cache[idx].name, name))
+      return foreign_address_cache[idx].address;
+  }
+  /* We  call  "dlerror()"  here   to  clean  up  possible  previous
+     errors. */
+  dlerror();
+  sym = dlsym(RTLD_DEFAULT, name);
+  err = dlerror();
+  if (err) {
+    ik_abort("dlsym() failed to find foreign name %s: %s", name, err);
+  }
+  /* Keep at least one free slot, so that the probing above terminates. */
+  if (foreign_address_cache_count < (FOREIGN_ADDRESS_CACHE_SIZE - 1)) {
+    int		len  = 1 + strlen(name);
+    char *	copy = ik_malloc(len);
+    memcpy(copy, name, len);
+    foreign_address_cache[idx].name    = copy;
+    foreign_address_cache[idx].address = sym;
+    ++foreign_address_cache_count;
+  }
+  return sym;
+}
+void
+ik_flush_foreign_address_cache (void)
+/* Forget all the cached addresses. */
+{
+  if (foreign_address_cache_count) {
+    int		idx;
+    for (idx=0; idx<FOREIGN_ADDRESS_CACHE_SIZE; ++idx) {
+      if (foreign_address_cache[idx].name) {
+	ik_free(foreign_address_cache[idx].name, 1 + strlen(foreign_address_cache[idx].name));
+	foreign_address_cache[idx].name    = NULL;
+	foreign_address_cache[idx].address = NULL;
+      }
+    }
+    foreign_address_cache_count = 0;
+  }
+}
+
 
 static uint8_t
 fasl_read_byte (fasl_port_t * port)
@@ -0,0 +1,315 @@
+/*
+ * Ikarus Scheme -- A compiler for R6RS Scheme.
+ * Copyright (C) 2006,2007,2008  Abdulaziz Ghuloum
+ * Modified by Marco Maggi <marco.maggi-ipsu@poste.it>
+ *
+ * This program is free software:  you can redistribute it and/or modify
+ * it under  the terms of  the GNU General  Public License version  3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is  distributed in the hope that it  will be useful, but
+ * WITHOUT  ANY   WARRANTY;  without   even  the  implied   warranty  of
+ * MERCHANTABILITY  or FITNESS FOR  A PARTICULAR  PURPOSE.  See  the GNU
+ * General Public License for more details.
+ *
+ * You should  have received  a copy of  the GNU General  Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** --------------------------------------------------------------------
+ ** Headers.
+ ** ----------------------------------------------------------------- */
+
+#include "internals.h"
+
+#if ((defined __x86_64__) || (defined __i386__))
+#  include <immintrin.h>
+#  define IK_HASH_X86		1
+#else
+#  define IK_HASH_X86		0
+#endif
+
+/* Defined in "cpu_has_avx2.S". */
+#if (IK_HASH_X86)
+extern int cpu_has_avx2 (void);
+#endif
+
+
+/** --------------------------------------------------------------------
+ ** Hash function for memory blocks.
+ ** ----------------------------------------------------------------- */
+
+/* This is  the hash function used for  strings, bytevectors and bignums.
+   It is structured like XXH3:
+
+   - Blocks up  to 16 bytes are  read with two, possibly  overlapping, loads
+     and mixed with a 64-bit to 128-bit multiplication.
+
+   - Blocks up to 256 bytes are consumed 16 bytes at a time with the same
+     multiplication.
+
+   - Longer blocks  are consumed 64 bytes  (a "stripe") at a  time into 8
+     independent 64-bit accumulators, which  map directly to SSE2 and AVX2
+     registers; every 16 stripes the accumulators are scrambled.  The
+     vector kernels compute exactly the same values of the scalar one, so
+     hash values do not depend on the CPU.
+
+   This is not a cryptographic hash function. */
+
+#define STRIPE_LEN		64
+#define STRIPES_PER_BLOCK	16
+#define BLOCK_LEN		(STRIPE_LEN * STRIPES_PER_BLOCK)
+
+#define PRIME32_1		0x9E3779B1U
+#define PRIME32_2		0x85EBCA77U
+#define PRIME32_3		0xC2B2AE3DU
+#define PRIME64_1		0x9E3779B185EBCA87ULL
+#define PRIME64_2		0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3		0x165667B19E3779F9ULL
+#define PRIME64_4		0x85EBCA77C2B2AE63ULL
+#define PRIME64_5		0x27D4EB2F165667C5ULL
+
+/* The stripe  with index N in a  block uses the words  from N to N+7 as
+   key; the words from 16 to 23 are used to scramble and merge. */
+static const uint64_t IK_HASH_SECRET[24] __attribute__((aligned(32))) = {
+  0x07C3E62447CE57E9ULL, 0x2EC746997017125EULL, 0x1F1D1F01A9D9A510ULL, 0xE46893867C089F4EULL,
+  0x86056A0ACB0B79A2ULL, 0x87CFFFACF078F425ULL, 0xC0DF8EB985855A47ULL, 0xF13A2D6E8E1AE976ULL,
+  0xDB0AF0C78DAB8A6CULL, 0x964DC0C2546E2301ULL, 0x7A451E772D22BF79ULL, 0xFA8C2E87ECDC92F9ULL,
+  0x6598D69183535922ULL, 0x903E33C18CC9C5BCULL, 0x2DAC5231161DCA46ULL, 0x2F6F4CE7B583D83DULL,
+  0x40B8106029E0DDABULL, 0xE7849B9950A04F7EULL, 0xC3774FAA730EF045ULL, 0x22F412CB909429DBULL,
+  0xD971395EB58FE03FULL, 0x53ADE73A011C4BF8ULL, 0x2D99C8C3FA1ED6CFULL, 0x03332693CC80B94CULL
+};
+
+static inline uint64_t
+read64 (const uint8_t * p)
+{
+  uint64_t	v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+static inline uint64_t
+read32 (const uint8_t * p)
+{
+  uint32_t	v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+static inline uint64_t
+mul_fold64 (uint64_t a, uint64_t b)
+/* Multiply A and B as 128-bit integers and return the XOR of the high and
+   low halves of the product. */
+{
+#ifdef __SIZEOF_INT128__
+  __uint128_t	P = (__uint128_t)a * (__uint128_t)b;
+  return ((uint64_t)P) ^ ((uint64_t)(P >> 64));
+#else
+  uint64_t	lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  uint64_t	hi_lo = (a >> 32)        * (b & 0xFFFFFFFF);
+  uint64_t	lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+  uint64_t	hi_hi = (a >> 32)        * (b >> 32);
+  uint64_t	cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  uint64_t	upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  uint64_t	lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return lower ^ upper;
+#endif
+}
+static inline uint64_t
+avalanche (uint64_t H)
+{
+  H ^= H >> 37;
+  H *= 0x165667919E3779F9ULL;
+  H ^= H >> 32;
+  return H;
+}
+
+/* ------------------------------------------------------------------ */
+
+typedef void ik_hash_accumulate_fun_t (uint64_t * acc, const uint8_t * data,
+				       const uint64_t * key, ikuword_t number_of_stripes);
+
+static void
+accumulate_scalar (uint64_t * acc, const uint8_t * data, const uint64_t * key, ikuword_t number_of_stripes)
+/* Consume NUMBER_OF_STRIPES stripes from DATA into the accumulators; the
+   stripe with index N uses the words starting at KEY+N as key. */
+{
+  for (ikuword_t n=0; n<number_of_stripes; ++n, data += STRIPE_LEN, ++key) {
+    for (int i=0; i<8; ++i) {
+      uint64_t	v = read64(data + 8*i);
+      uint64_t	k = v ^ key[i];
+      acc[i ^ 1] += v;
+      acc[i]     += (k & 0xFFFFFFFF) * (k >> 32);
+    }
+  }
+}
+
+#if (IK_HASH_X86)
+__attribute__((target("sse2")))
+static void
+accumulate_sse2 (uint64_t * acc, const uint8_t * data, const uint64_t * key, ikuword_t number_of_stripes)
+{
+  __m128i *	xacc = (__m128i *)acc;
+  for (ikuword_t n=0; n<number_of_stripes; ++n, data += STRIPE_LEN, ++key) {
+    for (int i=0; i<4; ++i) {
+      __m128i	data_vec    = _mm_loadu_si128((const __m128i *)(data + 16*i));
+      __m128i	key_vec     = _mm_loadu_si128((const __m128i *)(key  +  2*i));
+      __m128i	data_key    = _mm_xor_si128(data_vec, key_vec);
+      __m128i	data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+      __m128i	product     = _mm_mul_epu32(data_key, data_key_hi);
+      __m128i	data_swap   = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+      xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], data_swap));
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+static void
+accumulate_avx2 (uint64_t * acc, const uint8_t * data, const uint64_t * key, ikuword_t number_of_stripes)
+{
+  __m256i *	xacc = (__m256i *)acc;
+  for (ikuword_t n=0; n<number_of_stripes; ++n, data += STRIPE_LEN, ++key) {
+    for (int i=0; i<2; ++i) {
+      __m256i	data_vec    = _mm256_loadu_si256((const __m256i *)(data + 32*i));
+      __m256i	key_vec     = _mm256_loadu_si256((const __m256i *)(key  +  4*i));
+      __m256i	data_key    = _mm256_xor_si256(data_vec, key_vec);
+      __m256i	data_key_hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+      __m256i	product     = _mm256_mul_epu32(data_key, data_key_hi);
+      __m256i	data_swap   = _mm256_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+      xacc[i] = _mm256_add_epi64(product, _mm256_add_epi64(xacc[i], data_swap));
+    }
+  }
+}
+#endif
+
+static ik_hash_accumulate_fun_t *
+select_accumulate (void)
+/* Select the kernel for  the running CPU.  SSE2 is always  there: we test
+   it in "ikarus_main()". */
+{
+#if (IK_HASH_X86)
+  return (cpu_has_avx2())? accumulate_avx2 : accumulate_sse2;
+#else
+  return accumulate_scalar;
+#endif
+}
+
+/* Selected at the first call; concurrent first calls store the same value. */
+static ik_hash_accumulate_fun_t *	accumulate = NULL;
+
+static inline void
+scramble (uint64_t * acc)
+{
+  for (int i=0; i<8; ++i) {
+    acc[i] ^= acc[i] >> 47;
+    acc[i] ^= IK_HASH_SECRET[16 + i];
+    acc[i] *= PRIME32_1;
+  }
+}
+
+static uint64_t
+hash_long (const uint8_t * data, ikuword_t len, uint64_t seed)
+/* Hash more than 256 bytes. */
+{
+  uint64_t	acc[8] __attribute__((aligned(32))) = {
+    PRIME32_3 + seed, PRIME64_1, PRIME64_2, PRIME64_3,
+    PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1
+  };
+  ikuword_t	number_of_blocks  = (len - 1) / BLOCK_LEN;
+  ikuword_t	number_of_stripes = ((len - 1) - (number_of_blocks * BLOCK_LEN)) / STRIPE_LEN;
+  if (NULL == accumulate) {
+    accumulate = select_accumulate();
+  }
+  for (ikuword_t n=0; n<number_of_blocks; ++n) {
+    accumulate(acc, data + n * BLOCK_LEN, IK_HASH_SECRET, STRIPES_PER_BLOCK);
+    scramble(acc);
+  }
+  accumulate(acc, data + number_of_blocks * BLOCK_LEN, IK_HASH_SECRET, number_of_stripes);
+  /* The last stripe, possibly overlapping the previous one. */
+  accumulate_scalar(acc, data + len - STRIPE_LEN, IK_HASH_SECRET + 7, 1);
+  {
+    uint64_t	H = len * PRIME64_1;
+    for (int i=0; i<4; ++i) {
+      H += mul_fold64(acc[2*i] ^ IK_HASH_SECRET[16 + 2*i], acc[2*i + 1] ^ IK_HASH_SECRET[17 + 2*i]);
+    }
+    return avalanche(H);
+  }
+}
+
+uint64_t
+ik_hash_bytes (const void * mem, ikuword_t len, uint64_t seed)
+/* Compute and return the hash value of the  LEN bytes starting at MEM.
+   Blocks of  bytes with the same  contents and different SEED  usually
+   have different hash values. */
+{
+  const uint8_t *	data = mem;
+  if (len <= 16) {
+    uint64_t	a, b;
+    if (len >= 8) {
+      a = read64(data);
+      b = read64(data + len - 8);
+    } else if (len >= 4) {
+      a = read32(data);
+      b = read32(data + len - 4);
+    } else if (len > 0) {
+      a = (((uint64_t)data[0]) << 16) | (((uint64_t)data[len >> 1]) << 8) | data[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+    uint64_t	H = mul_fold64(a ^ IK_HASH_SECRET[0], b ^ IK_HASH_SECRET[1] ^ seed);
+    return avalanche(mul_fold64(H ^ len ^ IK_HASH_SECRET[2], PRIME64_1));
+  } else if (len <= 256) {
+    uint64_t	H = seed ^ (len * PRIME64_1);
+    ikuword_t	i;
+    for (i=0; i+16 < len; i += 16) {
+      H += mul_fold64(read64(data + i)     ^ IK_HASH_SECRET[(i >> 3)       & 15],
+		      read64(data + i + 8) ^ IK_HASH_SECRET[((i >> 3) + 1) & 15] ^ H);
+    }
+    /* The last 16 bytes, possibly overlapping the previous ones. */
+    H += mul_fold64(read64(data + len - 16) ^ IK_HASH_SECRET[16],
+		    read64(data + len - 8)  ^ IK_HASH_SECRET[17] ^ H);
+    return avalanche(H);
+  } else {
+    return hash_long(data, len, seed);
+  }
+}
+
+
+
+/** --------------------------------------------------------------------
+ ** Kernel selection for the test suite.
+ ** ----------------------------------------------------------------- */
+
+ikptr_t
+ikrt_hash_kernel_select (ikptr_t s_kernel, ikpcb_t * pcb)
+/* Select  the kernel used  by "hash_long()": S_KERNEL  is the fixnum  0 for
+   the best kernel  for the running CPU, 1 for the  scalar one, 2 for SSE2,
+   3 for AVX2.  Return true if the kernel  was selected, false if it is not
+   available.   All the kernels  compute the same  values: this  lets the
+   test suite check every one of them against the same known answers. */
+{
+  switch (IK_UNFIX(s_kernel)) {
+  case 0:
+    accumulate = select_accumulate();
+    return IK_TRUE;
+  case 1:
+    accumulate = accumulate_scalar;
+    return IK_TRUE;
+#if (IK_HASH_X86)
+  case 2:
+    accumulate = accumulate_sse2;
+    return IK_TRUE;
+  case 3:
+    if (cpu_has_avx2()) {
+      accumulate = accumulate_avx2;
+      return IK_TRUE;
+    } else {
+      return IK_FALSE;
+    }
+#endif
+  default:
+    return IK_FALSE;
+  }
+}
+
+/* end of file */
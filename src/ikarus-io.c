@@ -25,7 +25,10 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <setjmp.h>
+#include <signal.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -188,8 +191,196 @@ ikrt_write_fd (ikptr_t fd, ikptr_t buffer_bv, ikptr_t buffer_offset, ikptr_t req
   rv     = write(IK_NUM_TO_FD(fd), buffer, IK_UNFIX(requested_count));
   return (0 <= rv)? IK_FIX(rv) : ik_errno_to_code();
 }
+ikptr_t
+ikrt_writev_fd (ikptr_t fd,
+		ikptr_t buffer_bv, ikptr_t buffer_offset, ikptr_t buffer_count,
+		ikptr_t data_bv,   ikptr_t data_offset,   ikptr_t data_count
+		/*, ikpcb_t* pcb */)
+/* Write with a single "writev()" call the bytes buffered in a port and
+   a bytevector  given by  the caller,  so that  large writes  need not
+   be copied into the port buffer first.  Return a fixnum representing
+   the number of bytes written or an encoded ERRNO value. */
+{
+  struct iovec	iov[2];
+  ssize_t	rv;
+  iov[0].iov_base = ((uint8_t *)IK_BYTEVECTOR_DATA_VOIDP(buffer_bv)) + IK_UNFIX(buffer_offset);
+  iov[0].iov_len  = IK_UNFIX(buffer_count);
+  iov[1].iov_base = ((uint8_t *)IK_BYTEVECTOR_DATA_VOIDP(data_bv))   + IK_UNFIX(data_offset);
+  iov[1].iov_len  = IK_UNFIX(data_count);
+  errno = 0;
+  if (0 == iov[0].iov_len)
+    rv = write(IK_NUM_TO_FD(fd), iov[1].iov_base, iov[1].iov_len);
+  else
+    rv = writev(IK_NUM_TO_FD(fd), iov, 2);
+  return (0 <= rv)? IK_FIX(rv) : ik_errno_to_code();
+}
 
 
+/** --------------------------------------------------------------------
+ ** File descriptors handling for Scheme ports: memory-mapped input.
+ ** ----------------------------------------------------------------- */
+
+/* Input ports opened with the "mmap" file option map the whole file
+   read-only and refill the port buffer with "memcpy()" from the
+   mapping, rather than calling "read()".
+
+   If the file is truncated while it is mapped, touching the pages past
+   its new end raises SIGBUS.  Before each copy we "fstat()" the file and
+   copy only up to its current size, so a truncation is seen by the port
+   as end-of-file.  A truncation racing with the copy is caught by a
+   SIGBUS handler, installed when the first file is mapped, which jumps
+   back into "ikrt_read_mapped_fd()"; the copy then fails with EIO.  A
+   SIGBUS raised outside a copy is forwarded to the previous handler. */
+
+static sigjmp_buf * volatile	mapped_copy_jmp_buf = NULL;
+static struct sigaction		mapped_copy_old_sigbus;
+static int			mapped_copy_sigbus_installed = 0;
+
+static void
+mapped_copy_sigbus_handler (int signo, siginfo_t * info, void * uap)
+{
+  if (mapped_copy_jmp_buf) {
+    siglongjmp(*mapped_copy_jmp_buf, 1);
+  } else if (mapped_copy_old_sigbus.sa_flags & SA_SIGINFO) {
+    mapped_copy_old_sigbus.sa_sigaction(signo, info, uap);
+  } else if ((SIG_DFL == mapped_copy_old_sigbus.sa_handler) ||
+	     (SIG_IGN == mapped_copy_old_sigbus.sa_handler)) {
+    /* Returning  from a  fault  handler re-executes  the  faulting
+       instruction, so with the default action restored the process
+       terminates as if we were not here. */
+    sigaction(SIGBUS, &mapped_copy_old_sigbus, NULL);
+    raise(signo);
+  } else {
+    mapped_copy_old_sigbus.sa_handler(signo);
+  }
+}
+static int
+mapped_copy_install_sigbus_handler (void)
+/* Install the SIGBUS handler, if not already done.  Return 0 if
+   successful, -1 and set "errno" otherwise. */
+{
+  if (! mapped_copy_sigbus_installed) {
+    struct sigaction	sa;
+    sa.sa_sigaction = mapped_copy_sigbus_handler;
+    /* SA_NODEFER: we leave the handler with "siglongjmp()" and do not
+       save the signal mask in "sigsetjmp()", so SIGBUS must not stay
+       blocked. */
+    sa.sa_flags     = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    if (-1 == sigaction(SIGBUS, &sa, &mapped_copy_old_sigbus))
+      return -1;
+    mapped_copy_sigbus_installed = 1;
+  }
+  return 0;
+}
+
+ikptr_t
+ikrt_mapped_fd_size (ikptr_t s_fd, ikpcb_t * pcb)
+/* Return an exact integer representing the number of bytes in the
+   regular file referenced by S_FD.  Return false if S_FD is not a
+   regular file or it is empty: in this case the file must be read with
+   "read()".  If an error occurs: return an encoded ERRNO value. */
+{
+  struct stat	st;
+  int		rv;
+  errno = 0;
+  rv    = fstat(IK_NUM_TO_FD(s_fd), &st);
+  if (-1 == rv)
+    return ik_errno_to_code();
+  else if (S_ISREG(st.st_mode) && (0 < st.st_size) && (st.st_size == (off_t)(size_t)st.st_size))
+    return ika_integer_from_off_t(pcb, st.st_size);
+  else
+    return IK_FALSE_OBJECT;
+}
+ikptr_t
+ikrt_map_fd (ikptr_t s_fd, ikptr_t s_size, ikpcb_t * pcb)
+/* Map read-only S_SIZE bytes from the file referenced by S_FD.  If
+   successful return a pointer object referencing the mapped memory;
+   else return an encoded ERRNO value. */
+{
+  size_t	size = ik_integer_to_size_t(s_size);
+  void *	rv;
+  errno = 0;
+  if (mapped_copy_install_sigbus_handler())
+    return ik_errno_to_code();
+  rv    = mmap(NULL, size, PROT_READ, MAP_PRIVATE, IK_NUM_TO_FD(s_fd), 0);
+  if (MAP_FAILED == rv)
+    return ik_errno_to_code();
+#ifdef MADV_SEQUENTIAL
+  /* Ports consume data in order: let the kernel read ahead. */
+  madvise(rv, size, MADV_SEQUENTIAL);
+#endif
+  return ika_pointer_alloc(pcb, (ikuword_t)rv);
+}
+ikptr_t
+ikrt_unmap_fd (ikptr_t s_pointer, ikptr_t s_size /*, ikpcb_t * pcb */)
+{
+  int	rv;
+  errno = 0;
+  rv    = munmap(IK_POINTER_DATA_VOIDP(s_pointer), ik_integer_to_size_t(s_size));
+  return (-1 != rv)? IK_FALSE_OBJECT : ik_errno_to_code();
+}
+ikptr_t
+ikrt_read_mapped_fd (ikptr_t s_fd, ikptr_t s_pointer, ikptr_t s_map_size, ikptr_t s_map_offset,
+		     ikptr_t buffer_bv, ikptr_t buffer_offset, ikptr_t requested_count
+		     /*, ikpcb_t * pcb */)
+/* Copy at most REQUESTED_COUNT bytes from the mapped memory S_POINTER,
+   starting at S_MAP_OFFSET, into the bytevector BUFFER_BV, starting at
+   BUFFER_OFFSET.  S_FD is the mapped file.  Return a fixnum
+   representing the number of bytes copied: zero if the offset is at, or
+   past, the end of the mapping or of the file.  If an error occurs or
+   the file is truncated during the copy: return an encoded ERRNO
+   value.
+
+   The size of the file is checked with "fstat()" only when the copy
+   reaches the end of the mapping, or when reading a page past the end of
+   a truncated file raises SIGBUS: then we copy up to the new end of the
+   file, if there is still something to copy. */
+{
+  size_t		map_size   = ik_integer_to_size_t(s_map_size);
+  size_t		map_offset = ik_integer_to_size_t(s_map_offset);
+  volatile size_t	count      = (size_t)IK_UNFIX(requested_count);
+  volatile int		faulted    = 0;
+  uint8_t *		buffer;
+  struct stat		st;
+  sigjmp_buf		jmp_buf;
+  if (map_offset >= map_size)
+    return IK_FIX(0);
+  if (count >= map_size - map_offset) {
+    count = map_size - map_offset;
+    errno = 0;
+    if (-1 == fstat(IK_NUM_TO_FD(s_fd), &st))
+      return ik_errno_to_code();
+    if ((0 <= st.st_size) && ((uintmax_t)st.st_size < (uintmax_t)map_size)) {
+      if ((uintmax_t)st.st_size <= (uintmax_t)map_offset)
+	return IK_FIX(0);
+      count = (size_t)st.st_size - map_offset;
+    }
+  }
+  buffer = ((uint8_t *)IK_BYTEVECTOR_DATA_VOIDP(buffer_bv)) + IK_UNFIX(buffer_offset);
+  if (sigsetjmp(jmp_buf, 0)) {
+    /* The file has been truncated.  The first time we try again, copying
+       only the bytes still in the file; the second time we give up. */
+    mapped_copy_jmp_buf = NULL;
+    errno = 0;
+    if (faulted || (-1 == fstat(IK_NUM_TO_FD(s_fd), &st))) {
+      if (0 == errno)
+	errno = EIO;
+      return ik_errno_to_code();
+    }
+    faulted = 1;
+    if ((uintmax_t)st.st_size <= (uintmax_t)map_offset)
+      return IK_FIX(0);
+    if ((uintmax_t)st.st_size < (uintmax_t)(map_offset + count))
+      count = (size_t)st.st_size - map_offset;
+  }
+  mapped_copy_jmp_buf = &jmp_buf;
+  memcpy(buffer, ((uint8_t *)IK_POINTER_DATA_VOIDP(s_pointer)) + map_offset, count);
+  mapped_copy_jmp_buf = NULL;
+  return IK_FIX(count);
+}
+
+
 /** --------------------------------------------------------------------
  ** File descriptors handling for Scheme ports: port position.
  ** ----------------------------------------------------------------- */
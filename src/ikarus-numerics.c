@@ -2064,26 +2064,27 @@ ikrt_exact_bignum_sqrt(ikptr_t bn, ikpcb_t* pcb) {
 ikptr_t
 ikrt_flonum_hash (ikptr_t x /*, ikpcb_t* pcb */)
 {
-  uint16_t *	buf = (uint16_t*)(x+off_flonum_data);
-  ikptr_t		H   = ((iksword_t)(buf[0]))
-    ^ (((iksword_t)(buf[1])) << 3)
-    ^ (((iksword_t)(buf[3])) << 7)
-    ^ (((iksword_t)(buf[2])) << 11);
+  /* The bits of the flonum go through the MurmurHash3 64-bit finaliser. */
+  uint64_t	H;
+  memcpy(&H, (void *)(x+off_flonum_data), sizeof(H));
+  H ^= H >> 33;
+  H *= 0xFF51AFD7ED558CCDULL;
+  H ^= H >> 33;
+  H *= 0xC4CEB9FE1A85EC53ULL;
+  H ^= H >> 33;
   /* Make it positive. */
-  return IK_FIX((H << 4) >> 4);
+  return IK_FIX(((ikptr_t)H << 4) >> 4);
 }
 ikptr_t
 ikrt_bignum_hash (ikptr_t bn /*, ikpcb_t* pcb */)
 {
   ikptr_t	first_word	= IK_REF(bn, -vector_tag);
   ikuword_t	limb_count	= IK_BNFST_LIMB_COUNT(first_word);
-  ikuword_t	H		= (ikuword_t)first_word;
   mp_limb_t *	dat		= (mp_limb_t*)(bn+off_bignum_data);
-  for (ikuword_t i=0; i<limb_count; ++i) {
-    H = (H^dat[i]) << 3;
-  }
+  /* The first word holds the sign and the number of limbs. */
+  uint64_t	H		= ik_hash_bytes(dat, limb_count * sizeof(mp_limb_t), (uint64_t)first_word);
   /* Make it positive. */
-  return IK_FIX((H << 4) >> 4);
+  return IK_FIX(((ikptr_t)H << 4) >> 4);
 }
 
 /* end of file */
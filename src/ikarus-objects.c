@@ -31,6 +31,7 @@
 #include "internals.h"
 #include <gmp.h>
 #include <ctype.h>	/* for "isxdigit()" */
+#include <math.h>	/* for "isnan()", "signbit()" */
 
 
 /** --------------------------------------------------------------------
@@ -864,6 +865,227 @@ ik_is_symbol (ikptr_t obj)
 	  (symbol_tag == (symbol_mask & IK_REF(obj, off_symbol_record_tag))));
 }
 
+
+/** --------------------------------------------------------------------
+ ** Structural equality.
+ ** ----------------------------------------------------------------- */
+
+/* "ikrt_equal_fast()"  is an accelerator for  EQUAL?: it compares trees of
+   pairs and vectors  without allocating memory, comparing  strings and
+   bytevectors with "memcmp()".  It gives  up, leaving the work to the Scheme
+   implementation of EQUAL?, when:
+
+   - It finds  an object  whose equality is  not simply  EQ? or  EQV?: a
+     ratnum, a compnum...  Structs are compared as STRUCT=? does: same type
+     descriptor and fields equal according to EQV?; immutable pairs, whose
+     type descriptor is handed to us by EQUAL?, are compared like pairs.
+
+   - It  finds a  circular list  (detected with  the tortoise  and hare
+     algorithm), or the  nesting of pairs and vectors  exceeds the maximum
+     depth, or the number of visited compound objects exceeds the budget.
+     So shared and circular structures are left to the union-find algorithm
+     in Scheme. */
+
+#define EQUAL_FAST_NO		0
+#define EQUAL_FAST_YES		1
+#define EQUAL_FAST_UNKNOWN	2
+
+#define EQUAL_FAST_MAX_DEPTH	1000
+#define EQUAL_FAST_BUDGET	(1 << 20)
+
+static int
+flonum_eqv (double a, double b)
+/* Like EQV? applied to flonums: +0.0 and -0.0 are different, all the NaNs
+   are equal. */
+{
+  if (isnan(a)) {
+    return isnan(b);
+  } else if (isnan(b) || (a != b)) {
+    return 0;
+  } else if (0.0 == a) {
+    return (signbit(a) == signbit(b));
+  } else {
+    return 1;
+  }
+}
+static int
+eqv_fast (ikptr_t X, ikptr_t Y)
+/* Compare X and Y as EQV? does. */
+{
+  if (X == Y) {
+    return EQUAL_FAST_YES;
+  } else if (vector_tag == IK_TAGOF(X)) {
+    ikptr_t	first_word = IK_REF(X, -vector_tag);
+    if (flonum_tag == first_word) {
+      return (IK_IS_FLONUM(Y) && flonum_eqv(IK_FLONUM_DATA(X), IK_FLONUM_DATA(Y)))?
+	EQUAL_FAST_YES : EQUAL_FAST_NO;
+    } else if (ik_is_bignum(X)) {
+      return (ik_is_bignum(Y) && (first_word == IK_REF(Y, -vector_tag)) &&
+	      (0 == memcmp((void *)(X+off_bignum_data), (void *)(Y+off_bignum_data),
+			   IK_BNFST_LIMB_COUNT(first_word) * sizeof(mp_limb_t))))?
+	EQUAL_FAST_YES : EQUAL_FAST_NO;
+    } else if ((ratnum_tag == first_word) || (compnum_tag == first_word) || (cflonum_tag == first_word)) {
+      return EQUAL_FAST_UNKNOWN;
+    }
+  }
+  /* Every other object is EQV? only to itself. */
+  return EQUAL_FAST_NO;
+}
+static int
+equal_fast (ikptr_t X, ikptr_t Y, ikptr_t s_ipair_std, int depth, ikuword_t * budget)
+{
+  for (;;) {
+    if (X == Y) {
+      return EQUAL_FAST_YES;
+    } else if (IK_IS_FIXNUM(X) || (immediate_tag == IK_TAGOF(X)) || IK_IS_CLOSURE(X)) {
+      /* Fixnums, chars,  booleans and the other immediate objects  are EQV?
+	 only if they are EQ?; closures are EQUAL? only if they are EQ?. */
+      return EQUAL_FAST_NO;
+    } else if (IK_IS_PAIR(X)) {
+      ikptr_t	slow = X;
+      int	step = 0;
+      if (! IK_IS_PAIR(Y)) {
+	return EQUAL_FAST_NO;
+      }
+      if (EQUAL_FAST_MAX_DEPTH == depth) {
+	return EQUAL_FAST_UNKNOWN;
+      }
+      /* Compare the cars recursively and iterate over the cdrs. */
+      do {
+	if (0 == *budget) {
+	  return EQUAL_FAST_UNKNOWN;
+	}
+	--(*budget);
+	{
+	  int	rv = equal_fast(IK_CAR(X), IK_CAR(Y), s_ipair_std, 1+depth, budget);
+	  if (EQUAL_FAST_YES != rv) {
+	    return rv;
+	  }
+	}
+	X = IK_CDR(X);
+	Y = IK_CDR(Y);
+	if (step) {
+	  slow = IK_CDR(slow);
+	}
+	step = !step;
+	if (slow == X) {
+	  /* Circular list. */
+	  return EQUAL_FAST_UNKNOWN;
+	}
+      } while ((X != Y) && IK_IS_PAIR(X) && IK_IS_PAIR(Y));
+      /* Compare the tails. */
+      continue;
+    } else if (IK_IS_STRING(X)) {
+      ikuword_t	len = IK_STRING_LENGTH(X);
+      return (IK_IS_STRING(Y) && (len == IK_STRING_LENGTH(Y)) &&
+	      (0 == memcmp(IK_STRING_DATA_VOIDP(X), IK_STRING_DATA_VOIDP(Y), len * sizeof(ikchar_t))))?
+	EQUAL_FAST_YES : EQUAL_FAST_NO;
+    } else if (IK_IS_BYTEVECTOR(X)) {
+      ikuword_t	len = IK_BYTEVECTOR_LENGTH(X);
+      return (IK_IS_BYTEVECTOR(Y) && (len == IK_BYTEVECTOR_LENGTH(Y)) &&
+	      (0 == memcmp(IK_BYTEVECTOR_DATA_VOIDP(X), IK_BYTEVECTOR_DATA_VOIDP(Y), len)))?
+	EQUAL_FAST_YES : EQUAL_FAST_NO;
+    } else if (vector_tag == IK_TAGOF(X)) {
+      ikptr_t	first_word = IK_REF(X, -vector_tag);
+      if (IK_IS_FIXNUM(first_word)) {
+	/* X is a vector. */
+	ikuword_t	len = IK_UNFIX(first_word);
+	if (! IK_IS_VECTOR(Y)) {
+	  return EQUAL_FAST_NO;
+	} else if (len != IK_VECTOR_LENGTH(Y)) {
+	  return EQUAL_FAST_NO;
+	} else if (EQUAL_FAST_MAX_DEPTH == depth) {
+	  return EQUAL_FAST_UNKNOWN;
+	} else if (0 == *budget) {
+	  return EQUAL_FAST_UNKNOWN;
+	}
+	--(*budget);
+	for (ikuword_t i=0; i<len; ++i) {
+	  ikptr_t	x = IK_ITEM(X, i);
+	  ikptr_t	y = IK_ITEM(Y, i);
+	  /* The test "x == y" is inlined: vectors of fixnums and chars
+	     are compared word by word. */
+	  if (x != y) {
+	    int	rv = equal_fast(x, y, s_ipair_std, 1+depth, budget);
+	    if (EQUAL_FAST_YES != rv) {
+	      return rv;
+	    }
+	  }
+	}
+	return EQUAL_FAST_YES;
+      } else if (flonum_tag == first_word) {
+	return (IK_IS_FLONUM(Y) && flonum_eqv(IK_FLONUM_DATA(X), IK_FLONUM_DATA(Y)))?
+	  EQUAL_FAST_YES : EQUAL_FAST_NO;
+      } else if (ik_is_bignum(X)) {
+	/* Bignums  are normalised:  they are equal  if their  first words
+	   (sign and number of limbs) and their limbs are equal. */
+	return (ik_is_bignum(Y) && (first_word == IK_REF(Y, -vector_tag)) &&
+		(0 == memcmp((void *)(X+off_bignum_data), (void *)(Y+off_bignum_data),
+			     IK_BNFST_LIMB_COUNT(first_word) * sizeof(mp_limb_t))))?
+	  EQUAL_FAST_YES : EQUAL_FAST_NO;
+      } else if (pointer_tag == first_word) {
+	return (IK_IS_POINTER(Y) && (IK_POINTER_DATA(X) == IK_POINTER_DATA(Y)))?
+	  EQUAL_FAST_YES : EQUAL_FAST_NO;
+      } else if (symbol_tag == (symbol_mask & first_word)) {
+	return EQUAL_FAST_NO;
+      } else if (IK_IS_STRUCT(X)) {
+	if (! (IK_IS_STRUCT(Y) && (first_word == IK_STRUCT_STD(Y)))) {
+	  return EQUAL_FAST_NO;
+	} else if (s_ipair_std == first_word) {
+	  /* An immutable pair: compare the car recursively and iterate over
+	     the cdr. */
+	  if (EQUAL_FAST_MAX_DEPTH == depth) {
+	    return EQUAL_FAST_UNKNOWN;
+	  } else if (0 == *budget) {
+	    return EQUAL_FAST_UNKNOWN;
+	  }
+	  --(*budget);
+	  {
+	    int	rv = equal_fast(IK_FIELD(X, 0), IK_FIELD(Y, 0), s_ipair_std, 1+depth, budget);
+	    if (EQUAL_FAST_YES != rv) {
+	      return rv;
+	    }
+	  }
+	  X = IK_FIELD(X, 1);
+	  Y = IK_FIELD(Y, 1);
+	  continue;
+	} else {
+	  /* Like STRUCT=?. */
+	  ikuword_t	len = IK_UNFIX(IK_STD_LENGTH(first_word));
+	  for (ikuword_t i=0; i<len; ++i) {
+	    int	rv = eqv_fast(IK_FIELD(X, i), IK_FIELD(Y, i));
+	    if (EQUAL_FAST_YES != rv) {
+	      return rv;
+	    }
+	  }
+	  return EQUAL_FAST_YES;
+	}
+      } else {
+	return EQUAL_FAST_UNKNOWN;
+      }
+    } else {
+      return EQUAL_FAST_UNKNOWN;
+    }
+  }
+}
+ikptr_t
+ikrt_equal_fast (ikptr_t s_obj1, ikptr_t s_obj2, ikptr_t s_ipair_std /*, ikpcb_t * pcb */)
+/* Compare S_OBJ1 and S_OBJ2 as EQUAL? does.  Return  true or false if the
+   result is known, the void object if the Scheme implementation of EQUAL?
+   must be used.  S_IPAIR_STD  is the type descriptor of immutable pairs.
+   No memory is allocated. */
+{
+  ikuword_t	budget = EQUAL_FAST_BUDGET;
+  switch (equal_fast(s_obj1, s_obj2, s_ipair_std, 0, &budget)) {
+  case EQUAL_FAST_YES:
+    return IK_TRUE;
+  case EQUAL_FAST_NO:
+    return IK_FALSE;
+  default:
+    return IK_VOID;
+  }
+}
+
 
 /** --------------------------------------------------------------------
  ** Scheme objects from C numbers.
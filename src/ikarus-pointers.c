@@ -101,6 +101,9 @@ ikptr_t
 ikrt_dlclose (ikptr_t x /*, ikpcb_t* pcb*/)
 {
   int	rv = dlclose(IK_POINTER_DATA_VOIDP(x));
+  /* The closed  library may have  been unloaded, taking with it functions
+     whose address is cached. */
+  ik_flush_foreign_address_cache();
   return (0 == rv) ? IK_TRUE_OBJECT : IK_FALSE_OBJECT;
 }
 ikptr_t
@@ -50,6 +50,14 @@ int		ik_garbage_collection_is_forbidden	= 0;
 ikuword_t	ik_customisable_heap_nursery_size	= IK_HEAPSIZE;
 ikuword_t	ik_customisable_stack_size		= IK_STACKSIZE;
 
+/* Automatic garbage collections of a generation whose last pause was longer
+   than this number of microseconds are postponed; zero means never. */
+ikuword_t	ik_gc_postponement_threshold_usecs	= 0;
+
+/* When true:  automatic  garbage collections  select  the generation to
+   collect with the adaptive schedule, otherwise with the fixed one. */
+int		ik_gc_adaptive_schedule			= 0;
+
 /* When true: internals inspection messages  are enabled.  It is used by
    the preprocessor macro "IK_RUNTIME_MESSAGE()". */
 int		ik_enabled_runtime_messages		= 0;
@@ -84,7 +92,8 @@ ikptr_t
 ik_mmap (ikuword_t size)
 /* Allocate new  memory pages.   All memory  allocation is  performed by
    this function.  The allocated memory  is initialised to a sequence of
-   IK_FORWARD_PTR words.
+   IK_FORWARD_PTR words when debugging, else it is left as handed to us by
+   the OS: filled with zeros.
 
    If  the allocated  memory  is  used for  the  Scheme  stack or  the
    generational pages:  we must initialise  every word to a  safe value.
@@ -125,8 +134,16 @@ ik_mmap (ikuword_t size)
      the  requested   size.   When  such  additional   machine  word  is
      allocated: we  have to initialise  it to something  valid.  Usually
      the safe value  to which we should initialise memory  is the fixnum
-     zero: a machine word with all the bits set to 0. */
+     zero: a machine word with all the bits set to 0.
+
+     Poisoning  touches  every page  of  the  mapping, so  it  makes  the
+     process pay for physical memory it  may not use for a long time (the
+     nursery  hot  block is  mostly  untouched  right after  allocation).
+     Fresh anonymous mappings  are already filled with  the fixnum zero,
+     so we poison only in the builds meant to catch bugs. */
+#if ((defined VICARE_DEBUGGING) || (defined VICARE_GC_INTEGRITY))
   memset(mem, -1, mapsize);
+#endif
 #ifdef VICARE_DEBUGGING
   ik_debug_message("%s: 0x%016lx .. 0x%016lx\n", __func__, (long)mem, ((long)(mem))+mapsize-1);
 #endif
@@ -158,6 +175,78 @@ ik_munmap (ikptr_t mem, ikuword_t size)
 #endif
 }
 
+
+/** --------------------------------------------------------------------
+ ** Returning cached pages to the OS.
+ ** ----------------------------------------------------------------- */
+
+static void
+os_release_pages (ikptr_t base, ikuword_t size)
+/* Tell  the OS  that we  do not  need the  physical memory  backing SIZE
+   bytes starting  at BASE; the pages  stay mapped and can  be reused at
+   any time: their contents is either the old one or zeros. */
+{
+#ifdef HAVE_MADVISE
+#  ifdef MADV_FREE
+  /* MADV_FREE is cheaper: the kernel reclaims the memory lazily, only if
+     there is memory pressure.  Older kernels reject it with EINVAL. */
+  if (0 == madvise((char *)base, size, MADV_FREE))
+    return;
+#  endif
+#  ifdef MADV_DONTNEED
+  madvise((char *)base, size, MADV_DONTNEED);
+#  endif
+#endif
+}
+
+void
+ik_decay_page_cache (ikpcb_t * pcb)
+/* Return to  the OS the physical  memory of the pages  in PCB's page cache
+   that have been idle  since the previous call to this  function.  This is
+   called by the garbage collector every few collections.
+
+   The list of  cached pages is managed as a  stack: pages are pushed and
+   popped at its head.  So the pages  that have not been recycled since the
+   previous  call  are  the  last  "cached_pages_low_water"  nodes;  of these
+   the  last  "cached_pages_released"  nodes have  already  been  released.
+   Releasing keeps the pages in the  cache: they form a second tier of the
+   pool,  still cheaper  to reuse  than a  fresh mapping.   The cache  has
+   constant size, so the garbage  collector unmaps the pages that do not
+   fit in it, as before. */
+{
+  int	count    = pcb->cached_pages_count;
+  int	idle     = pcb->cached_pages_low_water;
+  int	released = pcb->cached_pages_released;
+  if (idle > released) {
+    ikpage_t *	node = pcb->cached_pages;
+    ikptr_t	run_base = 0;
+    ikuword_t	run_size = 0;
+    int		i;
+    /* Skip the pages that are still hot. */
+    for (i = 0; i < count - idle; ++i)
+      node = node->next;
+    /* Release the  idle pages that are  not released yet.  Pages  split from
+       the same block are pushed in order of increasing address, so the list
+       holds them by decreasing address: we coalesce runs of adjacent pages
+       into a single system call. */
+    for (; i < count - released; ++i, node = node->next) {
+      if (run_size && (node->base + IK_PAGESIZE == run_base)) {
+	run_base  = node->base;
+	run_size += IK_PAGESIZE;
+      } else {
+	if (run_size)
+	  os_release_pages(run_base, run_size);
+	run_base = node->base;
+	run_size = IK_PAGESIZE;
+      }
+    }
+    if (run_size)
+      os_release_pages(run_base, run_size);
+    pcb->cached_pages_released = idle;
+  }
+  pcb->cached_pages_low_water = count;
+}
+
 
 /** --------------------------------------------------------------------
  ** Memory mapping and tagging for garbage collection.
@@ -166,6 +255,34 @@ ik_munmap (ikptr_t mem, ikuword_t size)
 static void set_page_range_type       (ikptr_t base, ikuword_t size, uint32_t type, ikpcb_t* pcb);
 static void extend_page_vectors_maybe (ikptr_t base, ikuword_t size, ikpcb_t* pcb);
 
+#if ((defined HAVE_MADVISE) && (defined MADV_HUGEPAGE))
+
+/* The size of a  transparent huge page on the platforms  we care about
+   (x86-64 and AArch64 with 4 KiB base pages). */
+#define IK_HUGE_PAGE_SIZE	((ikuword_t)(2 * 1024 * 1024))
+
+static ikptr_t
+mmap_huge_page_aligned (ikuword_t size)
+/* Map SIZE bytes starting at an address aligned to IK_HUGE_PAGE_SIZE and
+   advise the kernel to use huge pages  for them.  We map a larger block
+   and unmap the unaligned head and the tail. */
+{
+  ikuword_t	mapsize = size + IK_HUGE_PAGE_SIZE;
+  ikptr_t	mem     = ik_mmap(mapsize);
+  ikptr_t	base    = (mem + IK_HUGE_PAGE_SIZE - 1) & ~(IK_HUGE_PAGE_SIZE - 1);
+  ikuword_t	head    = base - mem;
+  ikuword_t	tail    = mapsize - head - size;
+  if (head)
+    ik_munmap(mem, head);
+  if (tail)
+    ik_munmap(base + size, tail);
+  /* This is only advice: if THP is disabled we get normal pages. */
+  madvise((char *)base, size, MADV_HUGEPAGE);
+  return base;
+}
+
+#endif
+
 ikptr_t
 ik_mmap_typed (ikuword_t size, uint32_t type, ikpcb_t* pcb)
 /* Allocate new  memory pages  or recycle  an old  memory page  from the
@@ -193,6 +310,12 @@ ik_mmap_typed (ikuword_t size, uint32_t type, ikpcb_t* pcb)
 	 pages. */
       pages->next	  = pcb->uncached_pages;
       pcb->uncached_pages = pages;
+      /* Update the decay accounting; see "ik_decay_page_cache()". */
+      --(pcb->cached_pages_count);
+      if (pcb->cached_pages_low_water > pcb->cached_pages_count)
+	pcb->cached_pages_low_water = pcb->cached_pages_count;
+      if (pcb->cached_pages_released > pcb->cached_pages_count)
+	pcb->cached_pages_released = pcb->cached_pages_count;
     } else {
       /* No cached page available: allocate a new page. */
       base = ik_mmap(size);
@@ -240,8 +363,21 @@ ik_mmap_code (ikuword_t aligned_size, int gen, ikpcb_t* pcb)
 }
 ikptr_t
 ik_mmap_mainheap (ikuword_t size, ikpcb_t* pcb)
-/* Allocate a memory segment tagged as part of the Scheme heap. */
+/* Allocate a memory segment tagged as part of the Scheme heap.
+
+   When the segment  is big enough: we align it  to the transparent huge
+   page size and  ask the kernel to  back it with huge  pages; the heap
+   nursery is  filled linearly  and scanned  at every  collection, so it
+   benefits from fewer TLB misses. */
 {
+#if ((defined HAVE_MADVISE) && (defined MADV_HUGEPAGE))
+  if (size >= IK_HUGE_PAGE_SIZE) {
+    ikptr_t	base = mmap_huge_page_aligned(size);
+    extend_page_vectors_maybe(base, size, pcb);
+    set_page_range_type(base, size, MAINHEAP_MT, pcb);
+    return base;
+  }
+#endif
   return ik_mmap_typed(size, MAINHEAP_MT, pcb);
 }
 static void
@@ -960,6 +1096,32 @@ ikrt_enable_disable_automatic_garbage_collection (ikptr_t s_enable, ikpcb_t * pc
   return IK_VOID;
 }
 
+/* ------------------------------------------------------------------ */
+
+ikptr_t
+ikrt_gc_postponement_threshold_ref (ikpcb_t * pcb)
+/* Return false if automatic garbage collections are never postponed,
+   otherwise return the threshold in microseconds. */
+{
+  if (ik_gc_postponement_threshold_usecs) {
+    return IK_FIX(ik_gc_postponement_threshold_usecs);
+  } else {
+    return IK_FALSE;
+  }
+}
+ikptr_t
+ikrt_gc_postponement_threshold_set (ikptr_t s_microseconds, ikpcb_t * pcb)
+/* Set the postponement threshold of automatic garbage collections; false
+   or zero disables postponing. */
+{
+  if (IK_FALSE == s_microseconds) {
+    ik_gc_postponement_threshold_usecs = 0;
+  } else {
+    ik_gc_postponement_threshold_usecs = (ikuword_t)IK_UNFIX(s_microseconds);
+  }
+  return IK_VOID;
+}
+
 
 /** --------------------------------------------------------------------
  ** Internals inspection messages.
@@ -1430,6 +1592,9 @@ ikrt_stats_now (ikptr_t t, ikpcb_t* pcb)
   }
   /* major bytes */
   IK_FIELD(t, 14) = IK_FIX(pcb->allocation_count_major);
+  /* large object space */
+  IK_FIELD(t, 15) = IK_FIX(pcb->large_objects_count);
+  IK_FIELD(t, 16) = IK_FIX(pcb->large_objects_bytes);
   return IK_VOID_OBJECT;
 }
 
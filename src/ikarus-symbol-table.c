@@ -26,27 +26,70 @@
 #undef NUM_OF_BUCKETS
 #define NUM_OF_BUCKETS		IK_CHUNK_SIZE /* power of 2 */
 
+static ikptr_t	compute_string_hash (ikptr_t str, ikptr_t s_max_len);
+
 
 static ikptr_t
-make_symbol_table (ikpcb_t* pcb)
+make_symbol_table (ikpcb_t* pcb, ikuword_t num_of_buckets)
 /* Build and return a new hash table to be used as symbol table for both
    common  symbols and  gensyms.   "Symbol table"  here  means a  Scheme
    vector of  buckets, in which  the value  in each bucket  references a
    proper list  of symbols;  empty bucket slots  are initialised  to the
-   fixnum zero.
+   fixnum zero.  NUM_OF_BUCKETS must be a power of 2.
 
    The vector is allocated outside  of the memory scanned by the garbage
    collector.  Later  some pages in the  vector may be  registered to be
    scanned. */
 {
-  ikuword_t	mem_size = IK_ALIGN_TO_NEXT_PAGE(disp_vector_data + NUM_OF_BUCKETS * wordsize);
+  ikuword_t	mem_size = IK_ALIGN_TO_NEXT_PAGE(disp_vector_data + num_of_buckets * wordsize);
   ikptr_t	s_symtab = ik_mmap_ptr(mem_size, 0, pcb) | vector_tag;
   /* Here we clear the whole allocated  memory block, which is *not* the
      data area of the vector object. */
   memset((char*)(s_symtab+off_vector_length), '\0', mem_size);
-  IK_VECTOR_LENGTH_FX(s_symtab) = IK_FIX(NUM_OF_BUCKETS);
+  IK_VECTOR_LENGTH_FX(s_symtab) = IK_FIX(num_of_buckets);
   return s_symtab;
 }
+static ikptr_t
+enlarge_symbol_table (ikpcb_t * pcb, ikptr_t s_old_table, int unique_string_key)
+/* Build and return a new symbol table with twice the buckets of S_OLD_TABLE
+   and move into it all the symbols in  S_OLD_TABLE.  The pairs of the
+   bucket lists are reused.  When  UNIQUE_STRING_KEY is true: the hash key of
+   the  symbols is  their  unique  string, else  it  is  their pretty
+   string.
+
+   The old table is left to the garbage collector.  The Scheme code in the
+   boot image reads the symbol table  as a vector of bucket lists, so the
+   layout of the table must not change. */
+{
+  ikuword_t	old_len     = IK_VECTOR_LENGTH(s_old_table);
+  ikuword_t	new_len     = 2 * old_len;
+  ikptr_t	s_new_table = make_symbol_table(pcb, new_len);
+  ikuword_t	i;
+  for (i=0; i<old_len; ++i) {
+    ikptr_t	s_list = IK_ITEM(s_old_table, i);
+    while (s_list && (IK_NULL_OBJECT != s_list)) {
+      ikptr_t	s_next = IK_CDR(s_list);
+      ikptr_t	s_sym  = IK_CAR(s_list);
+      ikptr_t	s_key  = IK_REF(s_sym, (unique_string_key)? off_symbol_record_ustring : off_symbol_record_string);
+      ikuword_t	idx    = compute_string_hash(s_key, IK_TRUE) & (new_len - 1);
+      ikptr_t	s_head = IK_ITEM(s_new_table, idx);
+      /* Empty buckets hold the fixnum zero; keep lists proper. */
+      IK_CDR(s_list) = (s_head)? s_head : IK_NULL_OBJECT;
+      IK_ITEM(s_new_table, idx) = s_list;
+      s_list = s_next;
+    }
+  }
+  /* The new table is in generation 0, so it will be scanned at the next
+     collection; but the pairs may be in an older generation and we have
+     mutated them. */
+  for (i=0; i<new_len; ++i) {
+    ikptr_t	s_list = IK_ITEM(s_new_table, i);
+    for (; s_list && (IK_NULL_OBJECT != s_list); s_list = IK_CDR(s_list)) {
+      IK_SIGNAL_DIRT_IN_PAGE_OF_POINTER(pcb, s_list + off_cdr);
+    }
+  }
+  return s_new_table;
+}
 ikptr_t
 ikrt_get_symbol_table (ikpcb_t* pcb)
 /* The symbol  table is created by  C language code,  but, after loading
@@ -83,40 +126,27 @@ strings_eqp (ikptr_t s_str1, ikptr_t s_str2)
 
 static ikptr_t
 compute_string_hash (ikptr_t str, ikptr_t s_max_len)
-/* one-at-a-time from http://burtleburtle.net/bob/hash/doobs.html */
+/* We hash the  32-bit "ikchar_t" values  as a block of bytes, using the
+   vectorised function "ik_hash_bytes()". */
 {
   ikptr_t	len  = IK_UNFIX(IK_REF(str, off_string_length));
   ikchar_t *	data = IK_STRING_DATA_IKCHARP(str);
-  ikchar_t *	last;
-  /* With this initialisation: two strings of different length will have
-     different  hash value  even  when  they have  equal  chars used  to
-     compute the hash value. */
-  ikptr_t	H    = len;
+  ikptr_t	limit;
   /* We  expect  S_MAX_LEN to  be:  false,  true, an  already  validated
      non-negative fixnum. */
-  {
-    ikptr_t	limit;
-    if (IK_FALSE == s_max_len) {
-      limit = HASH_GENERATION_CHARS_LIMIT;
-    } else if (IK_TRUE == s_max_len) {
-      limit = len;
-    } else {
-      limit = IK_UNFIX(s_max_len);
-    }
-    last  = data + ((len < limit)? len : limit);
-  }
-  /* one-at-a-time */
-  for (; data < last; ++data) {
-    ikchar_t	c = IK_CHAR32_TO_INTEGER(*data);
-    H = H + c;
-    H = H + (H << 10);
-    H = H ^ (H >> 6);
+  if (IK_FALSE == s_max_len) {
+    limit = HASH_GENERATION_CHARS_LIMIT;
+  } else if (IK_TRUE == s_max_len) {
+    limit = len;
+  } else {
+    limit = IK_UNFIX(s_max_len);
   }
-  H = H + (H << 3);
-  H = H ^ (H >> 11);
-  H = H + (H << 15);
+  /* With the length as seed: two strings of different length will have
+     different  hash value  even  when  they have  equal  chars used  to
+     compute the hash value. */
+  uint64_t	H = ik_hash_bytes(data, sizeof(ikchar_t) * ((len < limit)? len : limit), (uint64_t)len);
   /* Make it positive. */
-  return ((H << 4) >> 4);
+  return (((ikptr_t)H << 4) >> 4);
 }
 ikptr_t
 ikrt_string_hash (ikptr_t str, ikptr_t s_max_len, ikpcb_t * pcb)
@@ -127,38 +157,32 @@ ikptr_t
 ikrt_bytevector_hash (ikptr_t bv, ikptr_t s_max_len, ikpcb_t * pcb)
 {
   ikptr_t	len  = IK_BYTEVECTOR_LENGTH(bv);
-  uint8_t *	data = IK_BYTEVECTOR_DATA_UINT8P(bv);
-  uint8_t *	last;
-  /* With this initialisation: two  bytevectors of different length will
-     have different hash  value even when they have equal  bytes used to
-     compute the hash value. */
-  ikptr_t	H    = len;
+  ikptr_t	limit;
   /* We  expect  S_MAX_LEN to  be:  false,  true, an  already  validated
      non-negative fixnum. */
-  {
-    ikptr_t	limit;
-    if (IK_FALSE == s_max_len) {
-      limit = HASH_GENERATION_BYTES_LIMIT;
-    } else if (IK_TRUE == s_max_len) {
-      limit = len;
-    } else {
-      limit = IK_UNFIX(s_max_len);
-    }
-    last  = data + ((len < limit)? len : limit);
-  }
-  /* one-at-a-time */
-  for (; data < last; ++data) {
-    uint8_t	c = *data;
-    H = H + c;
-    H = H + (H << 10);
-    H = H ^ (H >> 6);
+  if (IK_FALSE == s_max_len) {
+    limit = HASH_GENERATION_BYTES_LIMIT;
+  } else if (IK_TRUE == s_max_len) {
+    limit = len;
+  } else {
+    limit = IK_UNFIX(s_max_len);
   }
-  H = H + (H << 3);
-  H = H ^ (H >> 11);
-  H = H + (H << 15);
+  /* With the length as seed: two  bytevectors of different length will
+     have different  hash value  even when  they have  equal bytes used to
+     compute the hash value. */
+  uint64_t	H = ik_hash_bytes(IK_BYTEVECTOR_DATA_UINT8P(bv), (len < limit)? len : limit, (uint64_t)len);
   /* Make it positive. */
-  H = ((H << 4) >> 4);
-  return IK_FIX(H);
+  return IK_FIX(((ikptr_t)H << 4) >> 4);
+}
+ikptr_t
+ikrt_bytevector_hash64 (ikptr_t bv, ikpcb_t * pcb)
+/* Return an exact integer  representing the full 64-bit hash value of all
+   the bytes in  BV.  Used to detect  changes in the contents  of files, so
+   the value  must not depend on  the word size  nor on the kernel  used by
+   "ik_hash_bytes()". */
+{
+  ikptr_t	len = IK_BYTEVECTOR_LENGTH(bv);
+  return ika_integer_from_uint64(pcb, ik_hash_bytes(IK_BYTEVECTOR_DATA_UINT8P(bv), len, (uint64_t)len));
 }
 
 
@@ -208,6 +232,10 @@ intern_string (ikptr_t s_unique_string, ikptr_t s_symbol_table, ikpcb_t* pcb)
     ikuword_t bucket_slot_pointer = s_symbol_table + off_vector_data + bucket_index * wordsize;
     IK_SIGNAL_DIRT_IN_PAGE_OF_POINTER(pcb, bucket_slot_pointer);
   }
+  /* Keep the average bucket list length below 1. */
+  if (++(pcb->symbol_table_count) >= IK_VECTOR_LENGTH(s_symbol_table)) {
+    pcb->symbol_table = enlarge_symbol_table(pcb, s_symbol_table, 0);
+  }
   return s_sym;
 }
 static ikptr_t
@@ -248,6 +276,10 @@ intern_unique_string (ikptr_t s_pretty_string, ikptr_t s_unique_string, ikptr_t
     ikuword_t bucket_slot_pointer = s_symbol_table + off_vector_data + bucket_index * wordsize;
     IK_SIGNAL_DIRT_IN_PAGE_OF_POINTER(pcb,bucket_slot_pointer);
   }
+  /* This function only interns gensyms. */
+  if (++(pcb->gensym_table_count) >= IK_VECTOR_LENGTH(s_symbol_table)) {
+    pcb->gensym_table = enlarge_symbol_table(pcb, s_symbol_table, 1);
+  }
   return s_sym;
 }
 ikptr_t
@@ -263,7 +295,7 @@ ikrt_intern_gensym (ikptr_t s_sym, ikpcb_t* pcb)
 {
   ikptr_t s_gensym_table = pcb->gensym_table;
   if (0 == s_gensym_table) {
-    pcb->gensym_table = s_gensym_table = make_symbol_table(pcb);
+    pcb->gensym_table = s_gensym_table = make_symbol_table(pcb, NUM_OF_BUCKETS);
   }
   ikptr_t s_unique_string = IK_REF(s_sym, off_symbol_record_ustring);
   int   hash_value      = compute_string_hash(s_unique_string, IK_TRUE);
@@ -292,6 +324,9 @@ ikrt_intern_gensym (ikptr_t s_sym, ikpcb_t* pcb)
     ikuword_t bucket_slot_pointer = s_gensym_table + off_vector_data + bucket_index * wordsize;
     IK_SIGNAL_DIRT_IN_PAGE_OF_POINTER(pcb,bucket_slot_pointer);
   }
+  if (++(pcb->gensym_table_count) >= IK_VECTOR_LENGTH(s_gensym_table)) {
+    pcb->gensym_table = enlarge_symbol_table(pcb, s_gensym_table, 1);
+  }
   return IK_TRUE_OBJECT;
 }
 ikptr_t
@@ -340,6 +375,7 @@ ikrt_unintern_gensym (ikptr_t s_sym, ikpcb_t* pcb)
 	 the containing pair from the bucket list. */
       IK_REF(s_sym, off_symbol_record_ustring) = IK_TRUE_OBJECT;
       *bucket_list_pointer = IK_CDR(s_bucket_list);
+      --(pcb->gensym_table_count);
       return IK_TRUE_OBJECT;
     } else {
       bucket_list_pointer = (ikptr_t *)(s_bucket_list + off_cdr);
@@ -358,7 +394,7 @@ iku_string_to_symbol (ikpcb_t * pcb, ikptr_t str)
   if (IK_FALSE_OBJECT == s_symbol_table)
     ik_abort("attempt to access dead symbol table");
   if (0 == s_symbol_table) {
-    pcb->symbol_table = s_symbol_table = make_symbol_table(pcb);
+    pcb->symbol_table = s_symbol_table = make_symbol_table(pcb, NUM_OF_BUCKETS);
   }
   return intern_string(str, s_symbol_table, pcb);
 }
@@ -380,7 +416,7 @@ ikrt_strings_to_gensym (ikptr_t s_pretty_string, ikptr_t s_unique_string, ikpcb_
 {
   ikptr_t s_gensym_table = pcb->gensym_table;
   if (0 == s_gensym_table) {
-    pcb->gensym_table = s_gensym_table = make_symbol_table(pcb);
+    pcb->gensym_table = s_gensym_table = make_symbol_table(pcb, NUM_OF_BUCKETS);
   }
   return intern_unique_string(s_pretty_string, s_unique_string, s_gensym_table, pcb);
 }
@@ -0,0 +1,386 @@
+/*
+ * Ikarus Scheme -- A compiler for R6RS Scheme.
+ * Copyright (C) 2006,2007,2008  Abdulaziz Ghuloum
+ * Modified by Marco Maggi <marco.maggi-ipsu@poste.it>
+ *
+ * This program is free software:  you can redistribute it and/or modify
+ * it under  the terms of  the GNU General  Public License version  3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is  distributed in the hope that it  will be useful, but
+ * WITHOUT  ANY   WARRANTY;  without   even  the  implied   warranty  of
+ * MERCHANTABILITY  or FITNESS FOR  A PARTICULAR  PURPOSE.  See  the GNU
+ * General Public License for more details.
+ *
+ * You should  have received  a copy of  the GNU General  Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** --------------------------------------------------------------------
+ ** Headers.
+ ** ----------------------------------------------------------------- */
+
+#include "internals.h"
+
+#if ((defined __x86_64__) || (defined __i386__))
+#  include <immintrin.h>
+#  define IK_UTF8_X86		1
+#else
+#  define IK_UTF8_X86		0
+#endif
+
+/* Defined in "cpu_has_avx2.S". */
+#if (IK_UTF8_X86)
+extern int cpu_has_avx2 (void);
+#endif
+
+#define CARRIAGE_RETURN		0x0D
+#define NEXT_LINE		0x85
+#define LINE_SEPARATOR		0x2028
+
+
+/** --------------------------------------------------------------------
+ ** ASCII kernels.
+ ** ----------------------------------------------------------------- */
+
+/* Nearly all the text we handle is ASCII, so both the decoder and the
+   encoder consume runs of ASCII characters with the kernels below and
+   fall back to the octet-by-octet code only for multi-octet sequences.
+
+   SSE2 is  always there on x86 (we test  it in "ikarus_main()"), AVX2
+   is selected at run time to scan for ASCII runs 32 octets at a time. */
+
+typedef ikuword_t ik_ascii_span_fun_t (const uint8_t * src, ikuword_t len);
+
+static ikuword_t
+ascii_span_scalar (const uint8_t * src, ikuword_t len)
+/* Return the number of ASCII octets at the beginning of SRC. */
+{
+  ikuword_t	i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t	word;
+    memcpy(&word, src + i, 8);
+    if (word & 0x8080808080808080ULL) break;
+  }
+  while ((i < len) && (src[i] < 0x80)) ++i;
+  return i;
+}
+
+#if (IK_UTF8_X86)
+__attribute__((target("sse2")))
+static ikuword_t
+ascii_span_sse2 (const uint8_t * src, ikuword_t len)
+{
+  ikuword_t	i = 0;
+  for (; i + 16 <= len; i += 16) {
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(src + i)))) break;
+  }
+  return i + ascii_span_scalar(src + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static ikuword_t
+ascii_span_avx2 (const uint8_t * src, ikuword_t len)
+{
+  ikuword_t	i = 0;
+  for (; i + 32 <= len; i += 32) {
+    if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(src + i)))) break;
+  }
+  return i + ascii_span_sse2(src + i, len - i);
+}
+#endif
+
+static ik_ascii_span_fun_t *
+select_ascii_span (void)
+{
+#if (IK_UTF8_X86)
+  return (cpu_has_avx2())? ascii_span_avx2 : ascii_span_sse2;
+#else
+  return ascii_span_scalar;
+#endif
+}
+
+/* Selected at the first call; concurrent first calls store the same value. */
+static ik_ascii_span_fun_t *	ascii_span = NULL;
+
+#if (IK_UTF8_X86)
+__attribute__((target("sse2")))
+#endif
+static void
+ascii_widen (ikchar_t * dst, const uint8_t * src, ikuword_t len)
+/* Store in DST the Scheme characters  for the LEN ASCII octets in SRC. */
+{
+  ikuword_t	i = 0;
+#if (IK_UTF8_X86)
+  const __m128i	zero = _mm_setzero_si128();
+  const __m128i	tag  = _mm_set1_epi32(char_tag);
+  for (; i + 16 <= len; i += 16) {
+    __m128i	octets = _mm_loadu_si128((const __m128i *)(src + i));
+    __m128i	lo16   = _mm_unpacklo_epi8(octets, zero);
+    __m128i	hi16   = _mm_unpackhi_epi8(octets, zero);
+    __m128i	w0     = _mm_unpacklo_epi16(lo16, zero);
+    __m128i	w1     = _mm_unpackhi_epi16(lo16, zero);
+    __m128i	w2     = _mm_unpacklo_epi16(hi16, zero);
+    __m128i	w3     = _mm_unpackhi_epi16(hi16, zero);
+    _mm_storeu_si128((__m128i *)(dst + i +  0), _mm_or_si128(_mm_slli_epi32(w0, char_shift), tag));
+    _mm_storeu_si128((__m128i *)(dst + i +  4), _mm_or_si128(_mm_slli_epi32(w1, char_shift), tag));
+    _mm_storeu_si128((__m128i *)(dst + i +  8), _mm_or_si128(_mm_slli_epi32(w2, char_shift), tag));
+    _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_or_si128(_mm_slli_epi32(w3, char_shift), tag));
+  }
+#endif
+  for (; i < len; ++i)
+    dst[i] = IK_CHAR32_FROM_INTEGER(src[i]);
+}
+
+#if (IK_UTF8_X86)
+__attribute__((target("sse2")))
+#endif
+static ikuword_t
+ascii_narrow (uint8_t * dst, const ikchar_t * src, ikuword_t len)
+/* Store in DST the  octets for the ASCII characters at  the beginning of
+   SRC, at most LEN of them; return the number of octets stored. */
+{
+  ikuword_t	i = 0;
+#if (IK_UTF8_X86)
+  for (; i + 16 <= len; i += 16) {
+    /* Code points above #x7F saturate to an octet with the high bit set. */
+    __m128i	w0  = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i +  0)), char_shift);
+    __m128i	w1  = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i +  4)), char_shift);
+    __m128i	w2  = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i +  8)), char_shift);
+    __m128i	w3  = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i + 12)), char_shift);
+    __m128i	oct = _mm_packus_epi16(_mm_packs_epi32(w0, w1), _mm_packs_epi32(w2, w3));
+    if (_mm_movemask_epi8(oct)) break;
+    _mm_storeu_si128((__m128i *)(dst + i), oct);
+  }
+#endif
+  for (; i < len; ++i) {
+    uint32_t	cp = IK_CHAR32_TO_INTEGER(src[i]);
+    if (cp >= 0x80) break;
+    dst[i] = (uint8_t)cp;
+  }
+  return i;
+}
+
+
+/** --------------------------------------------------------------------
+ ** UTF-8 decoding.
+ ** ----------------------------------------------------------------- */
+
+/* The  decoder accepts  only  well-formed  UTF-8: no  overlong  forms, no
+   surrogates, nothing above #x10FFFF.  It stops at the first sequence it
+   does not accept and leaves  it to the Scheme code, which  knows how to
+   honour the error handling mode of the caller. */
+
+static inline int
+utf8_decode_one (const uint8_t * src, ikuword_t len, uint32_t * code_point)
+/* Decode the multi-octet sequence at the  beginning of SRC.  Return the
+   number of octets in it, or zero  if the sequence is invalid or is not
+   complete in the first LEN octets. */
+{
+  uint8_t	b0 = src[0];
+  if ((0xC2 <= b0) && (b0 <= 0xDF)) {
+    if ((len < 2) || (0x80 != (src[1] & 0xC0))) return 0;
+    *code_point = ((b0 & 0x1F) << 6) | (src[1] & 0x3F);
+    return 2;
+  } else if ((0xE0 <= b0) && (b0 <= 0xEF)) {
+    uint8_t	lo = (0xE0 == b0)? 0xA0 : 0x80;
+    uint8_t	hi = (0xED == b0)? 0x9F : 0xBF;
+    if ((len < 3) || (src[1] < lo) || (hi < src[1]) || (0x80 != (src[2] & 0xC0))) return 0;
+    *code_point = ((b0 & 0x0F) << 12) | ((src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+    return 3;
+  } else if ((0xF0 <= b0) && (b0 <= 0xF4)) {
+    uint8_t	lo = (0xF0 == b0)? 0x90 : 0x80;
+    uint8_t	hi = (0xF4 == b0)? 0x8F : 0xBF;
+    if ((len < 4) || (src[1] < lo) || (hi < src[1]) ||
+	(0x80 != (src[2] & 0xC0)) || (0x80 != (src[3] & 0xC0)))
+      return 0;
+    *code_point = ((b0 & 0x07) << 18) | ((src[1] & 0x3F) << 12) | ((src[2] & 0x3F) << 6) | (src[3] & 0x3F);
+    return 4;
+  } else
+    return 0;
+}
+
+static ikuword_t
+utf8_decode (const uint8_t * src, ikuword_t src_len, ikchar_t * dst, ikuword_t dst_len,
+	     int stop_at_eol, ikuword_t * consumed)
+/* Decode characters from SRC into DST until: DST is full, SRC is empty
+   or SRC starts with a sequence we do not accept.  If STOP_AT_EOL is
+   true: also stop before the line-ending characters that need
+   conversion, that is carriage return, next line and line separator.
+   Return the number of characters stored, store in CONSUMED the number
+   of octets consumed. */
+{
+  ikuword_t	i = 0, j = 0;
+  if (! ascii_span) ascii_span = select_ascii_span();
+  while ((i < src_len) && (j < dst_len)) {
+    if (src[i] < 0x80) {
+      ikuword_t	room = ((src_len - i) < (dst_len - j))? (src_len - i) : (dst_len - j);
+      ikuword_t	n    = ascii_span(src + i, room);
+      if (stop_at_eol) {
+	const uint8_t *	cr = memchr(src + i, CARRIAGE_RETURN, n);
+	if (cr) n = cr - (src + i);
+	if (0 == n) break;
+      }
+      ascii_widen(dst + j, src + i, n);
+      i += n;
+      j += n;
+    } else {
+      uint32_t	cp;
+      int	len = utf8_decode_one(src + i, src_len - i, &cp);
+      if ((0 == len) || (stop_at_eol && ((NEXT_LINE == cp) || (LINE_SEPARATOR == cp))))
+	break;
+      dst[j++] = IK_CHAR32_FROM_INTEGER(cp);
+      i += len;
+    }
+  }
+  *consumed = i;
+  return j;
+}
+
+static ikuword_t
+utf8_count (const uint8_t * src, ikuword_t len, int * valid)
+/* Return the number of characters encoded in the LEN octets of SRC; set
+   VALID to false if SRC holds a sequence we do not accept. */
+{
+  ikuword_t	i = 0, count = 0;
+  if (! ascii_span) ascii_span = select_ascii_span();
+  *valid = 1;
+  while (i < len) {
+    if (src[i] < 0x80) {
+      ikuword_t	n = ascii_span(src + i, len - i);
+      i     += n;
+      count += n;
+    } else {
+      uint32_t	cp;
+      int	n = utf8_decode_one(src + i, len - i, &cp);
+      if (0 == n) {
+	*valid = 0;
+	break;
+      }
+      i += n;
+      ++count;
+    }
+  }
+  return count;
+}
+
+ikptr_t
+ikrt_utf8_decode_length (ikptr_t s_bv, ikptr_t s_start, ikptr_t s_end /*, ikpcb_t * pcb */)
+/* Return a fixnum representing the number of characters encoded in the
+   octets of S_BV between S_START included and S_END excluded; return
+   false if the octets are not well-formed UTF-8. */
+{
+  const uint8_t *	src = IK_BYTEVECTOR_DATA_UINT8P(s_bv);
+  int			valid;
+  ikuword_t		count;
+  count = utf8_count(src + IK_UNFIX(s_start), IK_UNFIX(s_end) - IK_UNFIX(s_start), &valid);
+  return (valid)? IK_FIX(count) : IK_FALSE_OBJECT;
+}
+ikptr_t
+ikrt_utf8_decode (ikptr_t s_bv,  ikptr_t s_bv_start,  ikptr_t s_bv_end,
+		  ikptr_t s_str, ikptr_t s_str_start, ikptr_t s_str_end,
+		  ikptr_t s_stop_at_eol, ikpcb_t * pcb)
+/* Decode characters from the octets of S_BV between S_BV_START included
+   and S_BV_END  excluded, storing them  in S_STR between  S_STR_START
+   included and S_STR_END excluded.  Return a pair whose car is the index
+   of the first octet not consumed and whose cdr is the index of the first
+   character not filled. */
+{
+  const uint8_t *	src	  = IK_BYTEVECTOR_DATA_UINT8P(s_bv) + IK_UNFIX(s_bv_start);
+  ikchar_t *		dst	  = IK_STRING_DATA_IKCHARP(s_str)   + IK_UNFIX(s_str_start);
+  ikuword_t		consumed;
+  ikuword_t		produced;
+  ikptr_t		s_pair;
+  produced = utf8_decode(src, IK_UNFIX(s_bv_end)  - IK_UNFIX(s_bv_start),
+			 dst, IK_UNFIX(s_str_end) - IK_UNFIX(s_str_start),
+			 (IK_FALSE_OBJECT != s_stop_at_eol), &consumed);
+  s_pair = ika_pair_alloc(pcb);
+  IK_CAR(s_pair) = IK_FIX(IK_UNFIX(s_bv_start)  + consumed);
+  IK_CDR(s_pair) = IK_FIX(IK_UNFIX(s_str_start) + produced);
+  return s_pair;
+}
+
+
+/** --------------------------------------------------------------------
+ ** UTF-8 encoding.
+ ** ----------------------------------------------------------------- */
+
+static ikuword_t
+utf8_encode (const ikchar_t * src, ikuword_t src_len, uint8_t * dst, ikuword_t dst_len,
+	     ikuword_t * consumed)
+/* Encode characters from SRC into DST  until SRC is empty or the next
+   character does not fit in DST.  Return  the number of octets stored,
+   store in CONSUMED the number of characters consumed. */
+{
+  ikuword_t	i = 0, j = 0;
+  while ((i < src_len) && (j < dst_len)) {
+    uint32_t	cp = IK_CHAR32_TO_INTEGER(src[i]);
+    if (cp < 0x80) {
+      ikuword_t	room = ((src_len - i) < (dst_len - j))? (src_len - i) : (dst_len - j);
+      ikuword_t	n    = ascii_narrow(dst + j, src + i, room);
+      i += n;
+      j += n;
+    } else if (cp < 0x800) {
+      if (dst_len - j < 2) break;
+      dst[j++] = 0xC0 | (cp >> 6);
+      dst[j++] = 0x80 | (cp & 0x3F);
+      ++i;
+    } else if (cp < 0x10000) {
+      if (dst_len - j < 3) break;
+      dst[j++] = 0xE0 | (cp >> 12);
+      dst[j++] = 0x80 | ((cp >> 6) & 0x3F);
+      dst[j++] = 0x80 | (cp & 0x3F);
+      ++i;
+    } else {
+      if (dst_len - j < 4) break;
+      dst[j++] = 0xF0 | (cp >> 18);
+      dst[j++] = 0x80 | ((cp >> 12) & 0x3F);
+      dst[j++] = 0x80 | ((cp >> 6)  & 0x3F);
+      dst[j++] = 0x80 | (cp & 0x3F);
+      ++i;
+    }
+  }
+  *consumed = i;
+  return j;
+}
+
+ikptr_t
+ikrt_utf8_encode_length (ikptr_t s_str, ikptr_t s_start, ikptr_t s_end /*, ikpcb_t * pcb */)
+/* Return a fixnum representing the number of octets needed to encode in
+   UTF-8 the characters of S_STR between S_START included and S_END
+   excluded; return false if the number is not a fixnum. */
+{
+  const ikchar_t *	src = IK_STRING_DATA_IKCHARP(s_str);
+  ikuword_t		len = 0;
+  for (ikuword_t i = IK_UNFIX(s_start); i < (ikuword_t)IK_UNFIX(s_end); ++i) {
+    uint32_t	cp = IK_CHAR32_TO_INTEGER(src[i]);
+    len += 1 + (cp >= 0x80) + (cp >= 0x800) + (cp >= 0x10000);
+  }
+  return (len <= (ikuword_t)most_positive_fixnum)? IK_FIX(len) : IK_FALSE_OBJECT;
+}
+ikptr_t
+ikrt_utf8_encode (ikptr_t s_str, ikptr_t s_str_start, ikptr_t s_str_end,
+		  ikptr_t s_bv,  ikptr_t s_bv_start,  ikptr_t s_bv_end,
+		  ikpcb_t * pcb)
+/* Encode the characters of S_STR between S_STR_START included and
+   S_STR_END excluded, storing the octets in S_BV between S_BV_START
+   included and S_BV_END excluded; a character is encoded only if all its
+   octets fit.  Return a pair whose car is the index of the first
+   character not consumed and whose cdr is the index of the first octet
+   not filled. */
+{
+  const ikchar_t *	src = IK_STRING_DATA_IKCHARP(s_str)   + IK_UNFIX(s_str_start);
+  uint8_t *		dst = IK_BYTEVECTOR_DATA_UINT8P(s_bv) + IK_UNFIX(s_bv_start);
+  ikuword_t		consumed;
+  ikuword_t		produced;
+  ikptr_t		s_pair;
+  produced = utf8_encode(src, IK_UNFIX(s_str_end) - IK_UNFIX(s_str_start),
+			 dst, IK_UNFIX(s_bv_end)  - IK_UNFIX(s_bv_start), &consumed);
+  s_pair = ika_pair_alloc(pcb);
+  IK_CAR(s_pair) = IK_FIX(IK_UNFIX(s_str_start) + consumed);
+  IK_CDR(s_pair) = IK_FIX(IK_UNFIX(s_bv_start)  + produced);
+  return s_pair;
+}
+
+/* end of file */
@@ -29,6 +29,7 @@ extern int		ik_enabled_runtime_messages;
 extern int		ik_garbage_collection_is_forbidden;
 extern ikuword_t	ik_customisable_heap_nursery_size;
 extern ikuword_t	ik_customisable_stack_size;
+extern int		ik_gc_adaptive_schedule;
 
 static ikuword_t	normalise_number_of_bytes_argument (const char * argument_description,
 							    int i, int argc, char** argv, int offset);
@@ -102,6 +103,16 @@ main (int argc, char** argv)
 	  ik_customisable_stack_size = IK_ALIGN_TO_NEXT_PAGE(num_of_bytes);
 	  ++i;
 	}
+	else if (0 == strcmp(argv[1+i], "gc-schedule=fixed")) {
+	  IK_RUNTIME_MESSAGE("fixed garbage collection schedule");
+	  ik_gc_adaptive_schedule = 0;
+	  ++i;
+	}
+	else if (0 == strcmp(argv[1+i], "gc-schedule=adaptive")) {
+	  IK_RUNTIME_MESSAGE("adaptive garbage collection schedule");
+	  ik_gc_adaptive_schedule = 1;
+	  ++i;
+	}
 	else {
 	  argv[j] = argv[i];
 	  ++j;
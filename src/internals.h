@@ -791,6 +791,20 @@ typedef struct ikpcb_t {
    *   Notice that  the page cache  is *not* registered in  the segments
    * vector:  if  the  array  falls   inside  the  region  delimited  by
    * "memory_base" and "memory_end", it is marked as "hole".
+   *
+   * cached_pages_count -
+   *     The number of nodes in the list of used nodes.
+   *
+   * cached_pages_low_water -
+   *     The minimum value  of "cached_pages_count" since the  last run of
+   *     "ik_decay_page_cache()".  The  last "cached_pages_low_water" nodes
+   *     in the  list of used  nodes reference  pages that have  not been
+   *     recycled in the meantime: they are idle.
+   *
+   * cached_pages_released -
+   *     The number of nodes, at the end of the list of used nodes, whose
+   *     page has  already been  returned to the  OS with  "madvise()": the
+   *     pages are still mapped, but their physical memory is not.
    */
 #define IK_PAGE_CACHE_NUM_OF_SLOTS	(IK_PAGESIZE * 1)
 #define IK_PAGE_CACHE_SIZE_IN_BYTES	(IK_PAGE_CACHE_NUM_OF_SLOTS * sizeof(ikpage_t))
@@ -798,6 +812,9 @@ typedef struct ikpcb_t {
   int			cached_pages_size;
   ikpage_t *		cached_pages;
   ikpage_t *		uncached_pages;
+  int			cached_pages_count;
+  int			cached_pages_low_water;
+  int			cached_pages_released;
 
   /* The value of "argv[0]" as handed to the "main()" function. */
   char *		argv0;
@@ -855,6 +872,10 @@ typedef struct ikpcb_t {
   ikptr_t		symbol_table;
   /* The hash table holding interned generated symbols. */
   ikptr_t		gensym_table;
+  /* The number of symbols in the tables above; when it reaches the number
+     of buckets the table is enlarged. */
+  ikuword_t		symbol_table_count;
+  ikuword_t		gensym_table_count;
 
   /* Array of linked lists; one for each GC generation.  The linked list
      holds  references  to  Scheme  values  that  must  not  be  garbage
@@ -899,6 +920,31 @@ typedef struct ikpcb_t {
   struct timeval	collect_stime;
   struct timeval	collect_rtime;
 
+  /* Number of  objects in the large  object space, and number  of bytes of
+     the page runs holding them, as of the end of the last collection. */
+  ikuword_t		large_objects_count;
+  ikuword_t		large_objects_bytes;
+
+  /* Size in  bytes of the nursery  hot block selected by  the adaptive
+     garbage collection schedule; zero  when the schedule did not adapt it
+     yet.  It is kept between "ik_customisable_heap_nursery_size", which
+     is configured by the user, and 16 times that value. */
+  ikuword_t		adaptive_heap_nursery_size;
+
+  /* State of the adaptive garbage collection schedule, indexed by
+     generation: number of bytes moved into every generation since it was
+     last collected, and number of bytes that survived its last
+     collection. */
+  ikuword_t		gc_promoted_bytes[IK_GC_GENERATION_COUNT];
+  ikuword_t		gc_survived_bytes[IK_GC_GENERATION_COUNT];
+
+  /* State of the postponement of automatic garbage collections, indexed by
+     generation: last pause time measured for its collection, in
+     microseconds, zero if unknown; number of times its collection was
+     postponed since it was last performed. */
+  ikuword_t		gc_last_pause_usecs[IK_GC_GENERATION_COUNT];
+  int			gc_postponed_collections[IK_GC_GENERATION_COUNT];
+
   /* Collection of objects not to be collected. */
   void *		not_to_be_collected;
 
@@ -1007,12 +1053,15 @@ ik_private_decl ikptr_t	ik_mmap_data		(ikuword_t size, int gen, ikpcb_t*);
 ik_private_decl ikptr_t	ik_mmap_code		(ikuword_t size, int gen, ikpcb_t*);
 ik_private_decl ikptr_t	ik_mmap_mainheap	(ikuword_t size, ikpcb_t*);
 ik_private_decl void	ik_munmap		(ikptr_t, ikuword_t);
+ik_private_decl void	ik_decay_page_cache	(ikpcb_t*);
 ik_private_decl ikpcb_t * ik_make_pcb		(void);
 ik_private_decl void	ik_delete_pcb		(ikpcb_t*);
 ik_private_decl void	ik_free_symbol_table	(ikpcb_t* pcb);
+ik_private_decl uint64_t	ik_hash_bytes		(const void * mem, ikuword_t len, uint64_t seed);
 
 ik_private_decl void	ik_fasl_load		(ikpcb_t* pcb, const char * filename);
 ik_private_decl void	ik_relocate_code	(ikptr_t);
+ik_private_decl void	ik_flush_foreign_address_cache (void);
 
 ik_private_decl ikptr_t	ik_exec_code		(ikpcb_t* pcb, ikptr_t code_ptr, ikptr_t argcount, ikptr_t cp);
 